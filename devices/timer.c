@@ -19,6 +19,31 @@ static int64_t ticks;
 
 static unsigned loops_per_tick;
 
+/* 8254 input clock, in Hz, and the counter value that makes
+   channel 0 fire TIMER_FREQ times per second. */
+#define PIT_HZ 1193180
+#define PIT_TICK_COUNT ((PIT_HZ + TIMER_FREQ / 2) / TIMER_FREQ)
+
+/* Longest period, in ticks, that fits in the 16-bit counter. */
+#define PIT_MAX_TICKS (UINT16_MAX / PIT_TICK_COUNT)
+
+/* -tickless: Stop the periodic tick while only the idle thread
+   can run?  Controlled by kernel command-line option "-tickless". */
+bool timer_tickless;
+
+/* Ticks covered by the current stretched period, or 0 while the
+   timer runs at TIMER_FREQ.  The period was programmed to end on
+   a tick boundary, so it runs for IDLE_PERIOD * PIT_TICK_COUNT
+   PIT counts less whatever part of the first tick had already
+   gone by. */
+static int64_t idle_period;
+
+/* Number of timer interrupts that tickless mode avoided. */
+static int64_t skipped_ticks;
+
+static void pit_program(uint16_t count);
+static uint16_t pit_read(void);
+static bool pit_irq_pending(void);
 static intr_handler_func timer_interrupt;
 static bool too_many_loops(unsigned loops);
 static void busy_wait(int64_t loops);
@@ -26,11 +51,7 @@ static void real_time_sleep(int64_t num, int32_t denom);
 
 void timer_init(void)
 {
-	uint16_t count = (1193180 + TIMER_FREQ / 2) / TIMER_FREQ;
-
-	outb(0x43, 0x34);
-	outb(0x40, count & 0xff);
-	outb(0x40, count >> 8);
+	pit_program(PIT_TICK_COUNT);
 
 	intr_register_ext(0x20, timer_interrupt, "8254 Timer");
 }
@@ -105,12 +126,110 @@ void timer_nsleep(int64_t ns)
 void timer_print_stats(void)
 {
 	printf("Timer: %" PRId64 " ticks\n", timer_ticks());
+	if (timer_tickless)
+		printf("Timer: %" PRId64 " ticks skipped while idle\n", skipped_ticks);
+}
+
+/* Called by the idle thread, with interrupts off, just before it
+   halts the CPU.  In tickless mode, stretches the next timer
+   period so that it ends at the earliest sleep deadline instead
+   of after one tick. */
+void timer_idle_enter(void)
+{
+	int64_t period;
+	uint16_t done;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	/* A pending tick has not been counted yet, so PERIOD would be
+	   one too long; let it be delivered first. */
+	if (!timer_tickless || idle_period != 0 || pit_irq_pending())
+		return;
+
+	period = get_next_to_wakeup() - ticks;
+	if (period > PIT_MAX_TICKS)
+		period = PIT_MAX_TICKS;
+	if (period <= 1)
+		return;
+
+	/* Reprogramming restarts the count, so take off the part of the
+	   current tick that has already gone by. */
+	done = PIT_TICK_COUNT - pit_read();
+	idle_period = period;
+	pit_program(period * PIT_TICK_COUNT - done);
+}
+
+/* Called by the idle thread after the CPU wakes up.  If some
+   other interrupt ended the halt before the stretched period ran
+   out, accounts for the whole ticks that have already passed and
+   programs a one-tick period for the rest of the current tick,
+   so that the thread that is about to run is preempted on time
+   and the part of the tick already spent is not lost. */
+void timer_idle_exit(void)
+{
+	enum intr_level old_level = intr_disable();
+
+	/* If the stretched period has already run out, its interrupt
+	   is pending in the PIC and will do the accounting itself. */
+	if (idle_period > 1 && !pit_irq_pending())
+	{
+		int64_t spent = idle_period * PIT_TICK_COUNT - pit_read();
+		int64_t elapsed = spent / PIT_TICK_COUNT;
+
+		ticks += elapsed;
+		skipped_ticks += elapsed;
+		idle_period = 1;
+		pit_program(PIT_TICK_COUNT - spent % PIT_TICK_COUNT);
+	}
+	intr_set_level(old_level);
+}
+
+/* Starts 8254 channel 0 in rate generator mode, interrupting
+   every COUNT input clock cycles. */
+static void
+pit_program(uint16_t count)
+{
+	/* 8254 input frequency divided by COUNT. */
+	outb(0x43, 0x34); /* CW: counter 0, LSB then MSB, mode 2, binary. */
+	outb(0x40, count & 0xff);
+	outb(0x40, count >> 8);
+}
+
+/* Returns the current value of 8254 channel 0's counter. */
+static uint16_t
+pit_read(void)
+{
+	uint8_t lo, hi;
+
+	outb(0x43, 0x00); /* Latch counter 0. */
+	lo = inb(0x40);
+	hi = inb(0x40);
+	return (hi << 8) | lo;
+}
+
+/* Returns true if the timer's IRQ 0 has been raised but not yet
+   delivered, according to the master PIC's request register. */
+static bool
+pit_irq_pending(void)
+{
+	outb(0x20, 0x0a); /* OCW3: next read of port 0x20 returns IRR. */
+	return (inb(0x20) & 0x01) != 0;
 }
 
 static void
 timer_interrupt(struct intr_frame *args UNUSED)
 {
-	ticks++;
+	if (idle_period != 0)
+	{
+		/* A stretched period ran out: it stood in for
+		   IDLE_PERIOD ticks.  Go back to the periodic tick. */
+		ticks += idle_period;
+		skipped_ticks += idle_period - 1;
+		idle_period = 0;
+		pit_program(PIT_TICK_COUNT);
+	}
+	else
+		ticks++;
 	thread_tick();
 
 	/*-------------------------[project 1]-------------------------*/
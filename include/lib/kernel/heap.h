@@ -0,0 +1,78 @@
+#ifndef __LIB_KERNEL_HEAP_H
+#define __LIB_KERNEL_HEAP_H
+
+/* Priority queue.
+ *
+ * This is a pairing heap.  Like the list and hash table, it does
+ * not require use of dynamically allocated memory: each structure
+ * that can potentially be in a heap must embed a struct heap_elem
+ * member, and the heap_entry macro converts a struct heap_elem
+ * back to the structure that contains it.  That makes the heap
+ * safe to use with interrupts disabled, e.g. from the timer
+ * interrupt handler.
+ *
+ * The heap is ordered by a caller-supplied "less" function: the
+ * top of the heap is an element that no other element is less
+ * than.  To get a max-heap, supply a function that returns true
+ * if A is greater than B.
+ *
+ * Cost of the operations, for a heap of N elements:
+ *
+ * - heap_top(): O(1).
+ * - heap_insert(): O(1).
+ * - heap_pop(), heap_remove(), heap_update(): O(log N) amortized.
+ *
+ * Elements with equal keys come out in the order in which they
+ * were inserted, as with list_insert_ordered(). */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Heap element. */
+struct heap_elem {
+	struct heap_elem *child;    /* Leftmost child. */
+	struct heap_elem *next;     /* Next sibling. */
+	struct heap_elem *prev;     /* Previous sibling, or parent if this is
+	                               the leftmost child. */
+	uint64_t seq;               /* Insertion order, breaks ties. */
+};
+
+/* Converts pointer to heap element HEAP_ELEM into a pointer to
+   the structure that HEAP_ELEM is embedded inside.  Supply the
+   name of the outer structure STRUCT and the member name MEMBER
+   of the heap element. */
+#define heap_entry(HEAP_ELEM, STRUCT, MEMBER)           \
+	((STRUCT *) ((uint8_t *) &(HEAP_ELEM)->child    \
+		- offsetof (STRUCT, MEMBER.child)))
+
+/* Compares the value of two heap elements A and B, given
+   auxiliary data AUX.  Returns true if A is less than B, or
+   false if A is greater than or equal to B. */
+typedef bool heap_less_func (const struct heap_elem *a,
+                             const struct heap_elem *b,
+                             void *aux);
+
+/* Heap. */
+struct heap {
+	struct heap_elem *root;     /* Top of the heap, or null if empty. */
+	size_t elem_cnt;            /* Number of elements in heap. */
+	uint64_t next_seq;          /* Sequence number for next insertion. */
+	heap_less_func *less;       /* Comparison function. */
+	void *aux;                  /* Auxiliary data for `less'. */
+};
+
+void heap_init (struct heap *, heap_less_func *, void *aux);
+
+/* Heap properties. */
+size_t heap_size (const struct heap *);
+bool heap_empty (const struct heap *);
+struct heap_elem *heap_top (const struct heap *);
+
+/* Heap insertion and removal. */
+void heap_insert (struct heap *, struct heap_elem *);
+struct heap_elem *heap_pop (struct heap *);
+void heap_remove (struct heap *, struct heap_elem *);
+void heap_update (struct heap *, struct heap_elem *);
+
+#endif /* lib/kernel/heap.h */
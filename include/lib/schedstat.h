@@ -0,0 +1,17 @@
+#ifndef __LIB_SCHEDSTAT_H
+#define __LIB_SCHEDSTAT_H
+
+#include <stdint.h>
+
+/* Per-thread scheduler statistics, kept in struct thread by the
+   kernel and copied out to user programs by the schedstat()
+   system call.  Times are in timer ticks. */
+struct schedstat {
+	int64_t run_ticks;          /* Ticks spent running. */
+	int64_t ready_ticks;        /* Ticks spent ready but not running. */
+	int64_t voluntary_switches; /* Switched out because it blocked or yielded. */
+	int64_t involuntary_switches; /* Preempted on return from an interrupt. */
+	int64_t donations;          /* Priority donations received. */
+};
+
+#endif /* lib/schedstat.h */
@@ -36,6 +36,10 @@ enum {
 
 	SYS_MOUNT,
 	SYS_UMOUNT,
+
+	SYS_SCHEDSTAT,              /* Read this thread's scheduler statistics. */
+	SYS_FUTEX_WAIT,             /* Sleep while an int holds a value. */
+	SYS_FUTEX_WAKE,             /* Wake threads sleeping on an int. */
 };
 
 #endif /* lib/syscall-nr.h */
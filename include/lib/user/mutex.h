@@ -0,0 +1,22 @@
+#ifndef __LIB_USER_MUTEX_H
+#define __LIB_USER_MUTEX_H
+
+#include <stdbool.h>
+
+/* Mutual exclusion lock built on futex_wait() and futex_wake().
+   Locking and unlocking an uncontended mutex does not enter the
+   kernel. */
+struct mutex
+  {
+    int state;          /* 0: unlocked, 1: locked, 2: locked with
+                           possible waiters. */
+  };
+
+#define MUTEX_INITIALIZER { 0 }
+
+void mutex_init (struct mutex *);
+void mutex_lock (struct mutex *);
+bool mutex_trylock (struct mutex *);
+void mutex_unlock (struct mutex *);
+
+#endif /* lib/user/mutex.h */
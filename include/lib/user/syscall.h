@@ -4,6 +4,7 @@
 #include <stdbool.h>
 #include <debug.h>
 #include <stddef.h>
+#include <schedstat.h>
 
 /* Process identifier. */
 typedef int pid_t;
@@ -38,6 +39,14 @@ void close(int fd);
 
 int dup2(int oldfd, int newfd);
 
+/* Scheduler statistics of the calling thread. */
+void schedstat(struct schedstat *stats);
+
+/* Sleeps while *ADDR == VAL until woken; -1 if it already differs.
+   Wakes up to CNT sleepers on ADDR and returns how many woke. */
+int futex_wait(int *addr, int val);
+int futex_wake(int *addr, int cnt);
+
 /* Project 3 and optionally project 4. */
 void *mmap(void *addr, size_t length, int writable, int fd, off_t offset);
 void munmap(void *addr);
@@ -0,0 +1,56 @@
+#ifndef THREADS_FIXED_POINT_H
+#define THREADS_FIXED_POINT_H
+
+#include <stdint.h>
+
+/* 17.14 fixed-point real numbers for the 4.4BSD scheduler.
+   The kernel does not use the FPU, so load_avg and recent_cpu
+   are kept as ints whose low FP_SHIFT bits are the fraction.
+   Products and quotients of two fixed-point values go through
+   int64_t so that the intermediate result does not overflow. */
+typedef int fixed_t;
+
+#define FP_SHIFT 14
+#define FP_ONE (1 << FP_SHIFT)
+
+/* Converts integer N to fixed point. */
+static inline fixed_t
+fp_from_int(int n)
+{
+	return n * FP_ONE;
+}
+
+/* Converts X to an integer, rounding toward zero. */
+static inline int
+fp_to_int(fixed_t x)
+{
+	return x / FP_ONE;
+}
+
+/* Converts X to an integer, rounding to nearest. */
+static inline int
+fp_round(fixed_t x)
+{
+	return x >= 0 ? (x + FP_ONE / 2) / FP_ONE
+				  : (x - FP_ONE / 2) / FP_ONE;
+}
+
+static inline fixed_t
+fp_add_int(fixed_t x, int n)
+{
+	return x + n * FP_ONE;
+}
+
+static inline fixed_t
+fp_mul(fixed_t x, fixed_t y)
+{
+	return (fixed_t)(((int64_t)x) * y / FP_ONE);
+}
+
+static inline fixed_t
+fp_div(fixed_t x, fixed_t y)
+{
+	return (fixed_t)(((int64_t)x) * FP_ONE / y);
+}
+
+#endif /* threads/fixed-point.h */
@@ -28,6 +28,12 @@
 #define PTX(la)  ((((uint64_t) (la)) >> PTXSHIFT) & 0x1FF)
 #define PTE_ADDR(pte) ((uint64_t) (pte) & ~0xFFF)
 
+/* A page directory entry with PTE_PS set maps a 2 MB "huge" page
+   directly, instead of pointing to a page table. */
+#define HUGE_PGSIZE (1UL << PDXSHIFT)           /* Bytes in a huge page. */
+#define HUGE_PGCNT (HUGE_PGSIZE / PGSIZE)       /* Pages in a huge page. */
+#define HUGE_PGMASK (HUGE_PGSIZE - 1)           /* Offset bits in a huge page. */
+
 /* The important flags are listed below.
    When a PDE or PTE is not "present", the other flags are
    ignored.
@@ -41,5 +47,6 @@
 #define PTE_U 0x4                        /* 1=user/kernel, 0=kernel only. */
 #define PTE_A 0x20                       /* 1=accessed, 0=not acccessed. */
 #define PTE_D 0x40                       /* 1=dirty, 0=not dirty (PTEs only). */
+#define PTE_PS 0x80                      /* 1=2 MB page (PDEs only). */
 
 #endif /* threads/pte.h */
@@ -0,0 +1,41 @@
+#ifndef THREADS_SLAB_H
+#define THREADS_SLAB_H
+
+#include <list.h>
+#include <stddef.h>
+#include "threads/synch.h"
+
+/* Object constructor.  Called once on each object when the slab
+   holding it is created, not on every kmem_cache_alloc(), so
+   objects must be returned to kmem_cache_free() in their
+   constructed state. */
+typedef void kmem_ctor_func (void *obj);
+
+/* Cache of equally sized objects of one type. */
+struct kmem_cache {
+	const char *name;           /* Name (for statistics). */
+	size_t obj_size;            /* Object size, rounded up to ALIGN. */
+	size_t align;               /* Object alignment. */
+	kmem_ctor_func *ctor;       /* Constructor, or null. */
+	size_t objs_per_slab;       /* Objects in each slab. */
+	size_t color_max;           /* Largest color offset, in bytes. */
+	size_t color_next;          /* Color offset for the next slab. */
+
+	struct lock lock;           /* Protects the lists below. */
+	struct list partial_slabs;  /* Slabs with free and used objects. */
+	struct list full_slabs;     /* Slabs with no free objects. */
+	struct list empty_slabs;    /* Slabs with no used objects. */
+	size_t slab_cnt;            /* Number of slabs. */
+	size_t obj_cnt;             /* Number of objects in use. */
+
+	struct list_elem elem;      /* Element in list of all caches. */
+};
+
+void slab_init (void);
+void kmem_cache_init (struct kmem_cache *, const char *name,
+                      size_t size, size_t align, kmem_ctor_func *);
+void *kmem_cache_alloc (struct kmem_cache *);
+void kmem_cache_free (struct kmem_cache *, void *);
+void kmem_print_stats (void);
+
+#endif /* threads/slab.h */
@@ -3,13 +3,15 @@
 
 #include <list.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include "threads/interrupt.h"
+#include "lib/kernel/heap.h"
 
 /* A counting semaphore. */
 struct semaphore
 {
 	unsigned value;		 /* Current value. */
-	struct list waiters; /* List of waiting threads. */
-	int priority;
+	struct heap waiters; /* Waiting threads, highest priority on top. */
 };
 
 void sema_init(struct semaphore *, unsigned value);
@@ -18,23 +20,56 @@ bool sema_try_down(struct semaphore *);
 void sema_up(struct semaphore *);
 void sema_self_test(void);
 
+/* Contention counters shared by all locks with the same name,
+   kept only with -lockprof.  Times are in TSC cycles. */
+struct lock_stat
+{
+	const char *name;		  /* Name given at lock_init(). */
+	int64_t acquisitions;	  /* Times acquired. */
+	int64_t contended;		  /* Times found held on acquire. */
+	uint64_t wait_cycles;	  /* Total time spent waiting. */
+	uint64_t max_wait_cycles; /* Longest single wait. */
+	uint64_t hold_cycles;	  /* Total time held. */
+	uint64_t max_hold_cycles; /* Longest single hold. */
+};
+
+/* Entry in a thread's held_locks heap for one lock or rwlock the
+   thread holds, keyed by the highest priority waiting for it. */
+struct held_lock
+{
+	int max_priority;	   /* Highest priority among waiting threads. */
+	struct heap_elem elem; /* Element in holder's held_locks. */
+};
+
 /* Lock. */
 struct lock
 {
 	struct thread *holder;		/* Thread holding lock (for debugging). */
 	struct semaphore semaphore; /* Binary semaphore controlling access. */
+	struct held_lock held;		/* Entry in holder's held_locks. */
+	const char *name;			/* Name (for profiling). */
+	struct lock_stat *stat;		/* Profiling counters, or NULL. */
+	uint64_t taken_tsc;			/* TSC when the holder took it. */
 };
 
-void lock_init(struct lock *);
+/* If true, locks count contention into their struct lock_stat.
+   Controlled by kernel command-line option "-lockprof". */
+extern bool lock_profiling;
+
+void lock_init_named(struct lock *, const char *name);
+/* Names the lock after its initializer expression, e.g.
+   "&filesys_lock".  Hot locks use lock_init_named() instead. */
+#define lock_init(LOCK) lock_init_named(LOCK, #LOCK)
 void lock_acquire(struct lock *);
 bool lock_try_acquire(struct lock *);
 void lock_release(struct lock *);
 bool lock_held_by_current_thread(const struct lock *);
+void lock_print_stats(void);
 
 /* Condition variable. */
 struct condition
 {
-	struct list waiters; /* List of waiting threads. */
+	struct heap waiters; /* Waiting threads, highest priority on top. */
 };
 
 void cond_init(struct condition *);
@@ -42,6 +77,41 @@ void cond_wait(struct condition *, struct lock *);
 void cond_signal(struct condition *cond, struct lock *lock);
 void cond_broadcast(struct condition *, struct lock *);
 
+/* Reader-writer lock.
+ *
+ * Any number of threads may hold it shared, or one thread may hold
+ * it exclusively.  Once a writer is waiting, new readers wait too,
+ * so that a stream of readers cannot starve writers.  A waiting
+ * thread donates its priority to every current holder, and on
+ * through whatever lock or rwlock each holder is waiting for. */
+struct rwlock
+{
+	int readers;			   /* Number of threads holding it shared. */
+	struct thread *writer;	   /* Thread holding it exclusively, or NULL. */
+	struct list holders;	   /* struct rwlock_hold of each holder. */
+	struct heap read_waiters;  /* Threads waiting to read. */
+	struct heap write_waiters; /* Threads waiting to write. */
+};
+
+/* One thread's hold on one rwlock, so that donations can find
+   every holder.  Allocated by the acquiring thread before it takes
+   or waits for the rwlock, and freed when it releases it. */
+struct rwlock_hold
+{
+	struct rwlock *rwlock;		  /* Held or awaited rwlock. */
+	struct thread *thread;		  /* Holding thread. */
+	struct list_elem elem;		  /* Element in rwlock's holders. */
+	struct list_elem thread_elem; /* Element in thread's rw_holds. */
+	struct held_lock held;		  /* Entry in holder's held_locks. */
+};
+
+void rwlock_init(struct rwlock *);
+void rwlock_acquire_read(struct rwlock *);
+void rwlock_release_read(struct rwlock *);
+void rwlock_acquire_write(struct rwlock *);
+void rwlock_release_write(struct rwlock *);
+bool rwlock_held_by_current_thread(const struct rwlock *);
+
 /* Optimization barrier.
  *
  * The compiler will not reorder operations across an
@@ -55,9 +125,6 @@ void cond_broadcast(struct condition *, struct lock *);
 #endif /* threads/synch.h */
 
 /*-------------------------[project 1]-------------------------*/
-void donate_priority(void);
-void remove_with_lock(struct lock *lock);
 void refresh_priority(void);
-bool sem_priority_less(const struct list_elem *a, const struct list_elem *b, void *aux);
-bool donate_priority_less(struct list_elem *a, struct list_elem *b, void *aux);
+bool lock_priority_greater(const struct heap_elem *a, const struct heap_elem *b, void *aux);
 /*-------------------------[project 1]-------------------------*/
\ No newline at end of file
@@ -7,6 +7,9 @@
 #include "threads/interrupt.h"
 #include "threads/synch.h"
 #include "lib/kernel/hash.h"
+#include "lib/kernel/heap.h"
+#include "threads/fixed-point.h"
+#include <schedstat.h>
 #ifdef VM
 #include "vm/vm.h"
 #endif
@@ -33,12 +36,13 @@ typedef int tid_t;
 #define PRI_DEFAULT 31 /* Default priority. */
 #define PRI_MAX 63	   /* Highest priority. */
 
+/* Niceness range for the advanced scheduler. */
+#define NICE_MIN -20
+#define NICE_DEFAULT 0
+#define NICE_MAX 20
+
 /*----------------[project1]-------------------*/
 void thread_sleep(int64_t ticks);
-static struct list ready_list;
-
-static struct list sleep_list;
-void update_next_to_wake(int64_t local_ticks);
 int64_t get_next_to_wakeup(void);
 
 /*----------------[project1]-------------------*/
@@ -94,12 +98,11 @@ int64_t get_next_to_wakeup(void);
  * the `magic' member of the running thread's `struct thread' is
  * set to THREAD_MAGIC.  Stack overflow will normally change this
  * value, triggering the assertion. */
-/* The `elem' member has a dual purpose.  It can be an element in
- * the run queue (thread.c), or it can be an element in a
- * semaphore wait list (synch.c).  It can be used these two ways
- * only because they are mutually exclusive: only a thread in the
- * ready state is on the run queue, whereas only a thread in the
- * blocked state is on a semaphore wait list. */
+/* The `elem' member is an element in the run queue (thread.c).
+ * A blocked thread instead sits in a semaphore's waiter heap
+ * (synch.c) through `wait_elem'.  `wait_heap' names the heap whose
+ * order depends on this thread's priority, so that a donation to a
+ * blocked thread can move it up without re-sorting the waiters. */
 struct thread
 {
 	/* Owned by thread.c. */
@@ -109,17 +112,34 @@ struct thread
 	int priority;			   /* Priority. */
 
 	/* Shared between thread.c and synch.c. */
-	struct list_elem elem; /* List element. */
+	struct list_elem elem;			/* List element. */
+	struct heap_elem wait_elem;		/* Element in a semaphore's waiters. */
+	struct heap *wait_heap;			/* Heap ordered by our priority, or NULL. */
+	struct heap_elem *wait_heap_elem; /* Our element in wait_heap. */
 
 	/* local tick */
 	int64_t wake_up_tick;
+	struct heap_elem sleep_elem; /* Element in the sleep queue. */
+
+	/* Advanced scheduler (-mlfqs) state. */
+	int nice;				  /* Niceness. */
+	fixed_t recent_cpu;		  /* Recent CPU time, 17.14 fixed point. */
+	int64_t recent_cpu_epoch; /* Second up to which recent_cpu is decayed. */
+	bool background;		  /* Left out of load_avg. */
+
+	/* Scheduler statistics. */
+	struct list_elem all_elem; /* Element in the list of all threads. */
+	struct schedstat stats;	   /* Run/wait times and switch counts. */
+	int64_t ready_since;	   /* Tick at which it last became ready. */
+	uint64_t unblock_tsc;	   /* TSC at thread_unblock(), 0 if not timed. */
 
 	/*----------------[project1]-------------------*/
 	/* priority donaion 관련 element 추가 */
 	int init_priority;				// donation이후 우선순위를 초기화하기 위해 초기값 저장
 	struct lock *wait_on_lock;		// 해당 스레드가 대기하고 있는 lock자료구조 주소 저장
-	struct list donations;			// multiple donation 을 고려하기 위해사용
-	struct list_elem donation_elem; // multiple donation 을 고려하기 위해사용
+	struct heap held_locks;			// Locks held, max-heap on highest waiter priority
+	struct list rw_holds;			// struct rwlock_hold of each rwlock held
+	struct rwlock_hold *wait_on_rwlock; // Hold for the rwlock waited on, or NULL
 	/*----------------[project1]-------------------*/
 
 	/*----------------[project2]-------------------*/
@@ -171,6 +191,8 @@ void thread_start(void);
 
 void thread_tick(void);
 void thread_print_stats(void);
+void thread_get_stats(struct schedstat *);
+void thread_print_latency(void);
 
 typedef void thread_func(void *aux);
 tid_t thread_create(const char *name, int priority, thread_func *, void *);
@@ -184,12 +206,14 @@ const char *thread_name(void);
 
 void thread_exit(void) NO_RETURN;
 void thread_yield(void);
+void thread_preempt(void);
 
 int thread_get_priority(void);
 void thread_set_priority(int);
 
 int thread_get_nice(void);
 void thread_set_nice(int);
+void thread_set_background(void);
 int thread_get_recent_cpu(void);
 int thread_get_load_avg(void);
 
@@ -198,9 +222,9 @@ void do_iret(struct intr_frame *tf);
 // 준코 : 정의
 void thread_sleep(int64_t);
 void thread_wakeup(int64_t);
-void update_next_to_wake(int64_t local_ticks);
 int64_t get_next_to_wakeup(void);
 void test_max_priority(void);
+void thread_change_priority(struct thread *t, int priority);
 bool priority_less(const struct list_elem *a_, const struct list_elem *b_, void *aux UNUSED);
 
 #endif /* threads/thread.h */
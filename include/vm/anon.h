@@ -7,9 +7,16 @@ enum vm_type;
 struct anon_page {
     /* 특정 페이지가 저장된 섹터의 위치 */
     int swap_sector;
+    /* swap 에서 미리 읽어 frame 에 올려 두었지만 아직 매핑하지 않았으면 true.
+     * 이때 swap_sector 의 slot 도 그대로 남아 있다. */
+    bool read_ahead;
 };
 
 void vm_anon_init (void);
 bool anon_initializer (struct page *page, enum vm_type type, void *kva);
+void swap_print_stats (void);
+bool anon_is_swapped_out (struct page *page);
+void anon_read_ahead (struct page *page, void *kva);
+void anon_share_slot (struct page *dst, struct page *src);
 
 #endif
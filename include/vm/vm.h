@@ -4,9 +4,11 @@
 #include "threads/palloc.h"
 #include "lib/kernel/hash.h"
 
-struct list lru;
-struct lock lru_lock;
-struct lock kill_lock;
+/* Global frame table: every frame that holds a user page, in the
+ * order the clock hand visits them.  Protected by lru_lock. */
+extern struct list lru;
+extern struct lock lru_lock;
+extern struct lock kill_lock;
 
 enum vm_type {
 	/* page not initialized */
@@ -56,6 +58,7 @@ struct page {
 	struct hash_elem hash_elem;
 	bool writable;
 	struct thread *t;
+	struct list_elem share_elem;	/* Element in frame->sharers. */
 	
 
 	/* Per-type data are binded into the union.
@@ -74,7 +77,11 @@ struct page {
 struct frame {
 	void *kva;
 	struct page *page;
-	struct list_elem lru_elem;
+	struct list_elem lru_elem;	/* Element in lru, while the frame is in use. */
+	int64_t last_use;			/* Timer tick of the last observed use. */
+	int ref_cnt;				/* Number of pages mapping this frame. */
+	struct list sharers;		/* Pages other than PAGE sharing it (COW). */
+	bool evicting;				/* Being written out without lru_lock. */
 };
 
 /* The function table for page operations.
@@ -112,6 +119,8 @@ void spt_remove_page (struct supplemental_page_table *spt, struct page *page);
 
 // void vm_init (struct hash *vm);
 void vm_init (void);
+bool vm_set_evict_policy (const char *name);
+void vm_print_stats (void);
 bool vm_try_handle_fault (struct intr_frame *f, void *addr, bool user,
 		bool write, bool not_present);
 
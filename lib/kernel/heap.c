@@ -0,0 +1,201 @@
+#include "heap.h"
+#include "../debug.h"
+
+/* A pairing heap is a multiway tree that satisfies the heap
+   property: no child is less than its parent.  Each node keeps
+   a pointer to its leftmost child, and the children of a node
+   form a doubly linked sibling list.  The `prev' link of the
+   leftmost child points back at the parent, which lets us
+   unlink any element in O(1).
+
+   Two heaps are melded by making the root that is not less
+   than the other the new leftmost child of the other one.
+   Removing the root leaves a list of subtrees, which are melded
+   back together in two passes: pairwise left to right, then the
+   pairs right to left.  That second pass is what keeps the
+   amortized cost of removal logarithmic.
+
+   The implementation is iterative throughout, so a degenerate
+   heap cannot overflow a 4 kB kernel stack. */
+
+static bool elem_less (struct heap *,
+		const struct heap_elem *, const struct heap_elem *);
+static struct heap_elem *meld (struct heap *,
+		struct heap_elem *, struct heap_elem *);
+static struct heap_elem *meld_pairs (struct heap *, struct heap_elem *);
+static void detach (struct heap_elem *);
+
+/* Initializes heap H as an empty heap ordered by LESS, given
+   auxiliary data AUX. */
+void
+heap_init (struct heap *h, heap_less_func *less, void *aux) {
+	ASSERT (h != NULL);
+	ASSERT (less != NULL);
+
+	h->root = NULL;
+	h->elem_cnt = 0;
+	h->next_seq = 0;
+	h->less = less;
+	h->aux = aux;
+}
+
+/* Returns the number of elements in H. */
+size_t
+heap_size (const struct heap *h) {
+	return h->elem_cnt;
+}
+
+/* Returns true if H is empty, false otherwise. */
+bool
+heap_empty (const struct heap *h) {
+	return h->root == NULL;
+}
+
+/* Returns the top element of H, that is, an element that no
+   other element of H is less than.  Returns a null pointer if H
+   is empty. */
+struct heap_elem *
+heap_top (const struct heap *h) {
+	return h->root;
+}
+
+/* Inserts ELEM, which must not already be in a heap, into H. */
+void
+heap_insert (struct heap *h, struct heap_elem *elem) {
+	ASSERT (h != NULL);
+	ASSERT (elem != NULL);
+
+	elem->child = elem->next = elem->prev = NULL;
+	elem->seq = h->next_seq++;
+	h->root = meld (h, h->root, elem);
+	h->elem_cnt++;
+}
+
+/* Removes and returns the top element of H, which must not be
+   empty. */
+struct heap_elem *
+heap_pop (struct heap *h) {
+	struct heap_elem *top;
+
+	ASSERT (h != NULL);
+	ASSERT (!heap_empty (h));
+
+	top = h->root;
+	h->root = meld_pairs (h, top->child);
+	top->child = NULL;
+	h->elem_cnt--;
+	return top;
+}
+
+/* Removes ELEM, which must be in H, from H. */
+void
+heap_remove (struct heap *h, struct heap_elem *elem) {
+	struct heap_elem *sub;
+
+	ASSERT (h != NULL);
+	ASSERT (elem != NULL);
+
+	if (elem == h->root) {
+		heap_pop (h);
+		return;
+	}
+
+	detach (elem);
+	sub = meld_pairs (h, elem->child);
+	elem->child = NULL;
+	h->root = meld (h, h->root, sub);
+	h->elem_cnt--;
+}
+
+/* Restores the heap property after the key of ELEM, which must
+   be in H, has changed in either direction. */
+void
+heap_update (struct heap *h, struct heap_elem *elem) {
+	heap_remove (h, elem);
+	heap_insert (h, elem);
+}
+
+/* Unlinks non-root ELEM, together with its subtree, from its
+   parent and siblings. */
+static void
+detach (struct heap_elem *elem) {
+	ASSERT (elem->prev != NULL);
+
+	if (elem->prev->child == elem)
+		elem->prev->child = elem->next;
+	else
+		elem->prev->next = elem->next;
+	if (elem->next != NULL)
+		elem->next->prev = elem->prev;
+	elem->next = elem->prev = NULL;
+}
+
+/* Returns true if A should come out of H before B: A is less
+   than B, or they are equal and A was inserted first. */
+static bool
+elem_less (struct heap *h,
+		const struct heap_elem *a, const struct heap_elem *b) {
+	if (h->less (a, b, h->aux))
+		return true;
+	if (h->less (b, a, h->aux))
+		return false;
+	return a->seq < b->seq;
+}
+
+/* Melds the heaps rooted at A and B, either of which may be
+   null, and returns the new root.  A and B must not have
+   siblings. */
+static struct heap_elem *
+meld (struct heap *h, struct heap_elem *a, struct heap_elem *b) {
+	if (a == NULL)
+		return b;
+	if (b == NULL)
+		return a;
+	if (elem_less (h, b, a)) {
+		struct heap_elem *t = a;
+		a = b;
+		b = t;
+	}
+
+	/* Make B the leftmost child of A. */
+	b->prev = a;
+	b->next = a->child;
+	if (a->child != NULL)
+		a->child->prev = b;
+	a->child = b;
+	return a;
+}
+
+/* Melds the sibling list starting at FIRST into a single heap
+   and returns its root, or a null pointer if FIRST is null. */
+static struct heap_elem *
+meld_pairs (struct heap *h, struct heap_elem *first) {
+	struct heap_elem *pairs = NULL;
+	struct heap_elem *root = NULL;
+
+	/* First pass: meld siblings pairwise from left to right,
+	   stacking the results on PAIRS through their `next' links. */
+	while (first != NULL) {
+		struct heap_elem *a = first;
+		struct heap_elem *b = a->next;
+
+		first = b != NULL ? b->next : NULL;
+		a->next = a->prev = NULL;
+		if (b != NULL) {
+			b->next = b->prev = NULL;
+			a = meld (h, a, b);
+		}
+		a->next = pairs;
+		pairs = a;
+	}
+
+	/* Second pass: meld the pairs from right to left. */
+	while (pairs != NULL) {
+		struct heap_elem *next = pairs->next;
+
+		pairs->next = NULL;
+		root = meld (h, root, pairs);
+		pairs = next;
+	}
+	return root;
+}
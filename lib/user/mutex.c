@@ -0,0 +1,71 @@
+#include <mutex.h>
+#include <syscall.h>
+
+/* The mutex state goes 0 -> 1 on an uncontended lock and back to
+   0 on unlock, both with a single atomic instruction.  A thread
+   that finds the mutex locked sets it to 2 before it sleeps, so
+   that the holder knows to call futex_wake() when it unlocks.
+   This is the three-state mutex from Drepper's "Futexes Are
+   Tricky". */
+
+enum
+  {
+    UNLOCKED = 0,
+    LOCKED = 1,
+    CONTENDED = 2
+  };
+
+/* Atomically sets *P to NEW if it is OLD.  Returns the value *P
+   had before. */
+static int
+cmpxchg (int *p, int old, int new) 
+{
+  __atomic_compare_exchange_n (p, &old, new, false,
+                               __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+  return old;
+}
+
+/* Initializes M as unlocked. */
+void
+mutex_init (struct mutex *m) 
+{
+  m->state = UNLOCKED;
+}
+
+/* Acquires M, sleeping in the kernel only if another thread
+   holds it. */
+void
+mutex_lock (struct mutex *m) 
+{
+  int c = cmpxchg (&m->state, UNLOCKED, LOCKED);
+
+  if (c == UNLOCKED)
+    return;
+  if (c != CONTENDED)
+    c = __atomic_exchange_n (&m->state, CONTENDED, __ATOMIC_ACQUIRE);
+  while (c != UNLOCKED) 
+    {
+      futex_wait (&m->state, CONTENDED);
+      c = __atomic_exchange_n (&m->state, CONTENDED, __ATOMIC_ACQUIRE);
+    }
+}
+
+/* Acquires M if it is unlocked and returns true, otherwise
+   returns false without waiting. */
+bool
+mutex_trylock (struct mutex *m) 
+{
+  return cmpxchg (&m->state, UNLOCKED, LOCKED) == UNLOCKED;
+}
+
+/* Releases M, which the caller must hold, and wakes one waiter
+   if there may be any. */
+void
+mutex_unlock (struct mutex *m) 
+{
+  if (__atomic_fetch_sub (&m->state, 1, __ATOMIC_RELEASE) != LOCKED) 
+    {
+      __atomic_store_n (&m->state, UNLOCKED, __ATOMIC_RELEASE);
+      futex_wake (&m->state, 1);
+    }
+}
@@ -197,3 +197,18 @@ int umount(const char *path)
 {
 	return syscall1(SYS_UMOUNT, path);
 }
+
+void schedstat(struct schedstat *stats)
+{
+	syscall1(SYS_SCHEDSTAT, stats);
+}
+
+int futex_wait(int *addr, int val)
+{
+	return syscall2(SYS_FUTEX_WAIT, addr, val);
+}
+
+int futex_wake(int *addr, int cnt)
+{
+	return syscall2(SYS_FUTEX_WAKE, addr, cnt);
+}
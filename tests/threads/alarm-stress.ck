@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(alarm-stress) begin
+(alarm-stress) Creating 1000 threads to sleep 3 times each.
+(alarm-stress) Thread N sleeps (N % 10 + 1) * 10 ticks each time.
+(alarm-stress) All 1000 threads woke up 3 times in order.
+(alarm-stress) end
+EOF
+pass;
@@ -0,0 +1,62 @@
+/* Checks that timer_sleep() and timer_elapsed() keep wall time in
+   tickless mode when something other than the timer wakes the
+   idle CPU in the middle of a stretched period.
+
+   Each round prints a line longer than the serial transmit queue
+   just before sleeping, so the queued bytes drain through serial
+   interrupts while the thread sleeps and every one of them ends
+   the idle halt early.  The ticks that pass over all the rounds
+   are then compared with the time-stamp counter, calibrated
+   against the tick while the CPU is busy and the timer therefore
+   runs at its normal rate. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "devices/timer.h"
+#include "intrinsic.h"
+
+#define CALIBRATE_TICKS 25
+#define ROUND_CNT 10
+#define SLEEP_TICKS 10
+
+/* Ticks, measured by the TSC, that the timer may fall behind or
+   run ahead over the whole test. */
+#define SLACK_TICKS 2
+
+void
+test_alarm_tickless (void) 
+{
+  uint64_t cycles_per_tick, start_tsc;
+  int64_t start, ticks, wall_ticks;
+  int i;
+
+  /* Calibrate the TSC against busy-waited ticks. */
+  start = timer_ticks ();
+  while (timer_ticks () == start)
+    continue;
+  start = timer_ticks ();
+  start_tsc = rdtsc ();
+  while (timer_elapsed (start) < CALIBRATE_TICKS)
+    continue;
+  cycles_per_tick = (rdtsc () - start_tsc) / CALIBRATE_TICKS;
+
+  start = timer_ticks ();
+  start_tsc = rdtsc ();
+  for (i = 0; i < ROUND_CNT; i++)
+    {
+      msg ("round %d: ..................................................."
+           "...............................", i);
+      timer_sleep (SLEEP_TICKS);
+    }
+  ticks = timer_elapsed (start);
+  wall_ticks = (rdtsc () - start_tsc) / cycles_per_tick;
+
+  if (ticks < ROUND_CNT * SLEEP_TICKS)
+    fail ("slept only %lld ticks in %d rounds of %d",
+          ticks, ROUND_CNT, SLEEP_TICKS);
+  if (ticks < wall_ticks - SLACK_TICKS || ticks > wall_ticks + SLACK_TICKS)
+    fail ("timer counted %lld ticks while %lld ticks of wall time passed",
+          ticks, wall_ticks);
+  msg ("Timer stayed within %d ticks of wall time.", SLACK_TICKS);
+}
@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(alarm-tickless) begin
+(alarm-tickless) round 0: ..................................................................................
+(alarm-tickless) round 1: ..................................................................................
+(alarm-tickless) round 2: ..................................................................................
+(alarm-tickless) round 3: ..................................................................................
+(alarm-tickless) round 4: ..................................................................................
+(alarm-tickless) round 5: ..................................................................................
+(alarm-tickless) round 6: ..................................................................................
+(alarm-tickless) round 7: ..................................................................................
+(alarm-tickless) round 8: ..................................................................................
+(alarm-tickless) round 9: ..................................................................................
+(alarm-tickless) Timer stayed within 2 ticks of wall time.
+(alarm-tickless) end
+EOF
+pass;
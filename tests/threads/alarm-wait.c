@@ -1,6 +1,9 @@
 /* Creates N threads, each of which sleeps a different, fixed
    duration, M times.  Records the wake-up order and verifies
-   that it is valid. */
+   that it is valid.
+
+   alarm-stress does the same with a thousand threads, a hundred
+   of them sharing each duration, and only prints a summary. */
 
 #include <stdio.h>
 #include "tests/threads/tests.h"
@@ -11,6 +14,7 @@
 #include "devices/timer.h"
 
 static void test_sleep (int thread_cnt, int iterations);
+static void test_sleep_many (int thread_cnt, int iterations);
 
 void
 test_alarm_single (void) 
@@ -23,6 +27,12 @@ test_alarm_multiple (void)
 {
   test_sleep (5, 7);
 }
+
+void
+test_alarm_stress (void) 
+{
+  test_sleep_many (1000, 3);
+}
 
 /* Information about the test. */
 struct sleep_test 
@@ -82,7 +92,7 @@ test_sleep (int thread_cnt, int iterations)
   for (i = 0; i < thread_cnt; i++)
     {
       struct sleep_thread *t = threads + i;
-      char name[16];
+      char name[sizeof "thread " + 11];
       
       t->test = &test;
       t->id = i;
@@ -133,6 +143,93 @@ test_sleep (int thread_cnt, int iterations)
   free (threads);
 }
 
+/* Runs THREAD_CNT threads that sleep ITERATIONS times each.
+   Thread I sleeps (I % 10 + 1) * 10 ticks each time, so many
+   threads wake up on the same tick.  Verifies the wake-up order
+   and count like test_sleep(), but without printing every
+   wake-up. */
+static void
+test_sleep_many (int thread_cnt, int iterations) 
+{
+  struct sleep_test test;
+  struct sleep_thread *threads;
+  int *output, *op;
+  int product;
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  msg ("Creating %d threads to sleep %d times each.", thread_cnt, iterations);
+  msg ("Thread N sleeps (N %% 10 + 1) * 10 ticks each time.");
+
+  /* Allocate memory. */
+  threads = malloc (sizeof *threads * thread_cnt);
+  output = malloc (sizeof *output * iterations * thread_cnt * 2);
+  if (threads == NULL || output == NULL)
+    PANIC ("couldn't allocate memory for test");
+
+  lock_init (&test.output_lock);
+  test.iterations = iterations;
+  test.output_pos = output;
+
+  /* Don't let any sleeper run before all of them exist, so that
+     creating a thousand threads cannot eat into the first sleep. */
+  thread_set_priority (PRI_DEFAULT + 1);
+  for (i = 0; i < thread_cnt; i++)
+    {
+      struct sleep_thread *t = threads + i;
+      char name[sizeof "thread " + 11];
+      
+      t->test = &test;
+      t->id = i;
+      t->duration = (i % 10 + 1) * 10;
+      t->iterations = 0;
+
+      snprintf (name, sizeof name, "thread %d", i);
+      if (thread_create (name, PRI_DEFAULT, sleeper, t) == TID_ERROR)
+        fail ("couldn't create thread %d", i);
+    }
+  test.start = timer_ticks () + 100;
+  thread_set_priority (PRI_DEFAULT);
+
+  /* Wait long enough for all the threads to finish. */
+  timer_sleep (100 + iterations * 100 + 100);
+
+  /* Acquire the output lock in case some rogue thread is still
+     running. */
+  lock_acquire (&test.output_lock);
+
+  /* Check completion order. */
+  product = 0;
+  for (op = output; op < test.output_pos; op++) 
+    {
+      struct sleep_thread *t;
+      int new_prod;
+
+      ASSERT (*op >= 0 && *op < thread_cnt);
+      t = threads + *op;
+
+      new_prod = ++t->iterations * t->duration;
+      if (new_prod >= product)
+        product = new_prod;
+      else
+        fail ("thread %d woke up out of order (%d > %d)!",
+              t->id, product, new_prod);
+    }
+
+  /* Verify that we had the proper number of wakeups. */
+  for (i = 0; i < thread_cnt; i++)
+    if (threads[i].iterations != iterations)
+      fail ("thread %d woke up %d times instead of %d",
+            i, threads[i].iterations, iterations);
+  msg ("All %d threads woke up %d times in order.", thread_cnt, iterations);
+  
+  lock_release (&test.output_lock);
+  free (output);
+  free (threads);
+}
+
 /* Sleeper thread. */
 static void
 sleeper (void *t_) 
@@ -0,0 +1,85 @@
+/* Checks that a kmem_cache hands freed objects back out as they
+   were left, constructs each object only once when its slab is
+   created, colors successive slabs, and keeps exactly one empty
+   slab once every object has been freed. */
+
+#include <stdint.h>
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/slab.h"
+#include "threads/vaddr.h"
+
+#define OBJ_ALIGN 64
+
+struct obj
+  {
+    int state;                  /* Set by the constructor. */
+    char pad[100];
+  };
+
+static kmem_ctor_func obj_ctor;
+static int ctor_cnt;
+
+/* Lives on the list of all caches for the rest of the run. */
+static struct kmem_cache cache;
+
+void
+test_kmem_cache_reuse (void) 
+{
+  static struct obj *objs[PGSIZE / OBJ_ALIGN + 1];
+  struct obj *o, *p;
+  size_t n, i;
+
+  kmem_cache_init (&cache, "test-reuse", sizeof (struct obj), OBJ_ALIGN,
+                   obj_ctor);
+  n = cache.objs_per_slab;
+
+  o = kmem_cache_alloc (&cache);
+  if (o == NULL)
+    fail ("kmem_cache_alloc() failed");
+  if ((uintptr_t) o % OBJ_ALIGN != 0)
+    fail ("object %p is not %d-byte aligned", o, OBJ_ALIGN);
+  if (o->state != 1 || ctor_cnt != (int) n)
+    fail ("first slab constructed %d objects, expected %zu", ctor_cnt, n);
+  msg ("First slab constructed every object once.");
+
+  o->state = 2;
+  kmem_cache_free (&cache, o);
+  p = kmem_cache_alloc (&cache);
+  if (p != o || p->state != 2 || ctor_cnt != (int) n)
+    fail ("freed object was not handed back out as it was left");
+  msg ("Freed object came back as it was left.");
+
+  /* Fill the first slab, then take one object from a second. */
+  objs[0] = p;
+  for (i = 1; i <= n; i++)
+    if ((objs[i] = kmem_cache_alloc (&cache)) == NULL)
+      fail ("kmem_cache_alloc() failed");
+  if (ctor_cnt != 2 * (int) n || cache.slab_cnt != 2)
+    fail ("second slab not created when the first was full");
+  if (cache.color_max >= OBJ_ALIGN
+      && pg_ofs (objs[n]) != pg_ofs (objs[0]) + OBJ_ALIGN)
+    fail ("second slab starts at offset %zu, first at %zu",
+          (size_t) pg_ofs (objs[n]), (size_t) pg_ofs (objs[0]));
+  msg ("Second slab was created and colored.");
+
+  for (i = 0; i <= n; i++)
+    kmem_cache_free (&cache, objs[i]);
+  if (cache.obj_cnt != 0 || cache.slab_cnt != 1)
+    fail ("%zu slabs kept with %zu objects in use",
+          cache.slab_cnt, cache.obj_cnt);
+  o = kmem_cache_alloc (&cache);
+  if (o == NULL || ctor_cnt != 2 * (int) n)
+    fail ("kept slab was not reused");
+  kmem_cache_free (&cache, o);
+  msg ("One empty slab was kept and reused.");
+}
+
+static void
+obj_ctor (void *obj_) 
+{
+  struct obj *obj = obj_;
+
+  obj->state = 1;
+  ctor_cnt++;
+}
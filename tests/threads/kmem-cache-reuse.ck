@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(kmem-cache-reuse) begin
+(kmem-cache-reuse) First slab constructed every object once.
+(kmem-cache-reuse) Freed object came back as it was left.
+(kmem-cache-reuse) Second slab was created and colored.
+(kmem-cache-reuse) One empty slab was kept and reused.
+(kmem-cache-reuse) end
+EOF
+pass;
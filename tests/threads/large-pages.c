@@ -0,0 +1,66 @@
+/* Checks that the kernel's direct map uses 2 MB pages, that
+   palloc_get_huge_page() returns 2 MB aligned memory, and that a
+   2 MB user mapping is looked up correctly and splits into 4 kB
+   pages when one of them is unmapped. */
+
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/mmu.h"
+#include "threads/palloc.h"
+#include "threads/pte.h"
+#include "threads/vaddr.h"
+
+/* An arbitrary 2 MB aligned user address. */
+#define UADDR ((uint8_t *) 0x400000)
+
+void
+test_large_pages (void) 
+{
+  uint8_t *kpage;
+  uint64_t *pml4, *pde;
+  size_t i;
+
+  kpage = palloc_get_huge_page (PAL_ZERO);
+  if (kpage == NULL)
+    fail ("palloc_get_huge_page failed");
+  if ((vtop (kpage) & HUGE_PGMASK) != 0)
+    fail ("huge page at %p is not 2 MB aligned", kpage);
+  msg ("Huge page is 2 MB aligned.");
+
+  for (i = 0; i < HUGE_PGSIZE; i++)
+    if (kpage[i] != 0)
+      fail ("byte %zu of huge page is not zero", i);
+  for (i = 0; i < HUGE_PGCNT; i++)
+    kpage[i * PGSIZE] = i;
+
+  pde = pml4e_walk_huge (base_pml4, (uint64_t) kpage, 0);
+  if (pde == NULL || (*pde & (PTE_P | PTE_PS)) != (PTE_P | PTE_PS))
+    fail ("direct map of %p is not a 2 MB page", kpage);
+  msg ("Direct map uses 2 MB pages.");
+
+  pml4 = pml4_create ();
+  ASSERT (pml4 != NULL);
+  if (!pml4_set_huge_page (pml4, UADDR, kpage, true))
+    fail ("pml4_set_huge_page failed");
+  for (i = 0; i < HUGE_PGCNT; i++)
+    if (pml4_get_page (pml4, UADDR + i * PGSIZE) != kpage + i * PGSIZE)
+      fail ("page %zu of the 2 MB mapping is wrong", i);
+  msg ("2 MB user mapping resolves.");
+
+  pml4_clear_page (pml4, UADDR + PGSIZE);
+  pde = pml4e_walk_huge (pml4, (uint64_t) UADDR, 0);
+  if (*pde & PTE_PS)
+    fail ("mapping was not split");
+  if (pml4_get_page (pml4, UADDR + PGSIZE) != NULL)
+    fail ("cleared page is still mapped");
+  for (i = 0; i < HUGE_PGCNT; i++)
+    if (i != 1 && pml4_get_page (pml4, UADDR + i * PGSIZE) != kpage + i * PGSIZE)
+      fail ("page %zu moved when the mapping was split", i);
+  msg ("Split mapping keeps the other 511 pages.");
+
+  /* pml4_destroy() frees the pages that are still mapped. */
+  pml4_destroy (pml4);
+  palloc_free_page (kpage + PGSIZE);
+}
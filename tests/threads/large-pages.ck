@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(large-pages) begin
+(large-pages) Huge page is 2 MB aligned.
+(large-pages) Direct map uses 2 MB pages.
+(large-pages) 2 MB user mapping resolves.
+(large-pages) Split mapping keeps the other 511 pages.
+(large-pages) end
+EOF
+pass;
@@ -0,0 +1,53 @@
+/* Wakes a higher-priority thread a fixed number of times through a
+   semaphore.  Each wake-up goes through thread_unblock() and is
+   switched in right away, so the ready-to-running histogram that
+   the kernel prints at shutdown must count at least that many
+   wake-ups, all of them above the default priority.  The check
+   script reads the histogram. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+#define WAKE_CNT 200
+
+static thread_func waiter_func;
+static struct semaphore wake_sema, done_sema;
+static int wake_cnt;
+
+void
+test_latency_histogram (void) 
+{
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  sema_init (&wake_sema, 0);
+  sema_init (&done_sema, 0);
+  thread_create ("waiter", PRI_DEFAULT + 1, waiter_func, NULL);
+
+  msg ("Waking a higher-priority thread %d times.", WAKE_CNT);
+  for (i = 0; i < WAKE_CNT; i++)
+    sema_up (&wake_sema);
+  sema_down (&done_sema);
+
+  if (wake_cnt != WAKE_CNT)
+    fail ("waiter woke %d times instead of %d", wake_cnt, WAKE_CNT);
+  msg ("Waiter woke %d times.", WAKE_CNT);
+}
+
+static void
+waiter_func (void *aux UNUSED) 
+{
+  int i;
+
+  for (i = 0; i < WAKE_CNT; i++)
+    {
+      sema_down (&wake_sema);
+      wake_cnt++;
+    }
+  sema_up (&done_sema);
+}
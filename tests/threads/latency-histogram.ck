@@ -0,0 +1,39 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+# Besides the test's own messages, checks the histogram printed at
+# shutdown, which looks like this:
+#
+# Latency: 214 wake-ups, ready-to-running in TSC cycles
+#   [2^11, 2^12): 190 (188 above default priority)
+#   [2^12, 2^13): 24 (12 above default priority)
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+fail "Waiter did not wake up as often as it was woken.\n"
+  if !grep (/Waiter woke 200 times\./, @output);
+
+my ($total) = map (/^Latency: (\d+) wake-ups/, @output);
+fail "No latency histogram found in output.\n" if !defined $total;
+
+my ($sum, $above) = (0, 0);
+foreach (@output) {
+    next if !/^\s+\[2\^(\d+), 2\^(\d+)\): (\d+) \((\d+) above default/;
+    fail "Bucket [2^$1, 2^$2) is not one power of two wide.\n"
+      if $2 != $1 + 1;
+    fail "Bucket [2^$1, 2^$2) has more high-priority wake-ups than wake-ups.\n"
+      if $4 > $3;
+    $sum += $3;
+    $above += $4;
+}
+fail "Buckets add up to $sum wake-ups, but the total is $total.\n"
+  if $sum != $total;
+fail "Only $above wake-ups above the default priority, expected 200.\n"
+  if $above < 200;
+
+pass;
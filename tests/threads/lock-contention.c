@@ -0,0 +1,75 @@
+/* Has several threads at the same priority repeatedly acquire and
+   release one lock around a short critical section, so that the
+   timer regularly preempts a holder and the others contend for
+   the lock.  Checks that no increment was lost and reports the
+   acquire/release throughput. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define THREAD_CNT 8
+#define ACQUIRE_CNT 20000
+#define WORK_CNT 100
+
+static thread_func contender;
+static struct lock lock;
+static struct semaphore done;
+static volatile int64_t counter;
+
+void
+test_lock_contention (void) 
+{
+  int64_t start, elapsed, total;
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  msg ("%d threads will acquire a lock %d times each.",
+       THREAD_CNT, ACQUIRE_CNT);
+
+  lock_init (&lock);
+  sema_init (&done, 0);
+  counter = 0;
+
+  start = timer_ticks ();
+  for (i = 0; i < THREAD_CNT; i++) 
+    {
+      char name[16];
+      snprintf (name, sizeof name, "contender %d", i);
+      if (thread_create (name, PRI_DEFAULT, contender, NULL) == TID_ERROR)
+        fail ("couldn't create thread %d", i);
+    }
+  for (i = 0; i < THREAD_CNT; i++)
+    sema_down (&done);
+  elapsed = timer_elapsed (start);
+
+  total = (int64_t) THREAD_CNT * ACQUIRE_CNT;
+  if (counter != total)
+    fail ("counter is %lld instead of %lld", counter, total);
+  msg ("No increments were lost.");
+
+  msg ("%lld acquires in %lld ticks (%lld ns per acquire).",
+       total, elapsed,
+       elapsed * (1000000000 / TIMER_FREQ) / total);
+}
+
+static void 
+contender (void *aux UNUSED) 
+{
+  int i, j;
+
+  for (i = 0; i < ACQUIRE_CNT; i++) 
+    {
+      lock_acquire (&lock);
+      for (j = 0; j < WORK_CNT; j++)
+        barrier ();
+      counter++;
+      lock_release (&lock);
+    }
+  sema_up (&done);
+}
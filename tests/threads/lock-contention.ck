@@ -0,0 +1,29 @@
+# -*- perl -*-
+
+# The expected output looks like this, except that the timing
+# figures in the last line vary from run to run:
+#
+# (lock-contention) begin
+# (lock-contention) 8 threads will acquire a lock 20000 times each.
+# (lock-contention) No increments were lost.
+# (lock-contention) 160000 acquires in 52 ticks (3250 ns per acquire).
+# (lock-contention) end
+
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+fail "Increments were lost.\n"
+  if !grep (/No increments were lost\./, @output);
+
+my ($acquires) = map (/(\d+) acquires in \d+ ticks/, @output);
+fail "No throughput report found in output.\n" if !defined $acquires;
+fail "$acquires acquires reported instead of 160000.\n"
+  if $acquires != 160000;
+
+pass;
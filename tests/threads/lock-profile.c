@@ -0,0 +1,58 @@
+/* Runs with -lockprof.  Makes a few higher-priority threads wait
+   on one lock while we hold it, and takes a second lock several
+   times with nobody else around, so that the check script can
+   compare the contention report printed at shutdown against what
+   actually happened to each lock. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+#define WAITER_CNT 3
+#define FREE_CNT 10
+
+static thread_func waiter_func;
+static struct lock contended_lock, free_lock;
+
+void
+test_lock_profile (void) 
+{
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+  ASSERT (lock_profiling);
+
+  lock_init_named (&contended_lock, "test-contended");
+  lock_init_named (&free_lock, "test-free");
+
+  for (i = 0; i < FREE_CNT; i++) 
+    {
+      lock_acquire (&free_lock);
+      lock_release (&free_lock);
+    }
+
+  /* Each waiter preempts us, finds the lock held and blocks. */
+  lock_acquire (&contended_lock);
+  for (i = 0; i < WAITER_CNT; i++) 
+    {
+      char name[16];
+
+      snprintf (name, sizeof name, "waiter %d", i);
+      thread_create (name, PRI_DEFAULT + 1, waiter_func, NULL);
+    }
+  msg ("%d threads are waiting for the lock.", WAITER_CNT);
+
+  /* The waiters take the lock in turn and finish before we run. */
+  lock_release (&contended_lock);
+  msg ("All waiters got the lock.");
+}
+
+static void
+waiter_func (void *aux UNUSED) 
+{
+  lock_acquire (&contended_lock);
+  lock_release (&contended_lock);
+}
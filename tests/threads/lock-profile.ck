@@ -0,0 +1,60 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+# Besides the test's own messages, checks the -lockprof report
+# printed at shutdown, which looks like this:
+#
+# Lock contention, by total wait (TSC cycles):
+# lock                   acquires  contended     total wait     max wait     avg hold     max hold
+# test-contended                4          3        1234567       456789         2345        12345
+# ...
+# test-free                    10          0              0            0          120          480
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+fail "Waiters did not all get the lock.\n"
+  if !grep (/All waiters got the lock\./, @output);
+
+my ($start) = grep ($output[$_] =~ /^Lock contention, by total wait/,
+                    0...$#output);
+fail "No lock contention report found in output.\n" if !defined $start;
+
+my (%stats, $last_wait);
+foreach (@output[$start + 2...$#output]) {
+    my ($name, $acq, $cont, $wait, $max_wait, $avg_hold, $max_hold)
+      = /^(.+?)\s+(\d+)\s+(\d+)\s+(\d+)\s+(\d+)\s+(\d+)\s+(\d+)$/
+      or last;
+    fail "Lock $name is listed after one with less total wait.\n"
+      if defined $last_wait && $wait > $last_wait;
+    fail "Lock $name was contended more often than it was acquired.\n"
+      if $cont > $acq;
+    fail "Lock $name has a longer maximum than total wait.\n"
+      if $max_wait > $wait;
+    fail "Lock $name has a longer average than maximum hold.\n"
+      if $avg_hold > $max_hold;
+    $stats{$name} = [$acq, $cont, $wait];
+    $last_wait = $wait;
+}
+
+my ($cl) = $stats{"test-contended"};
+fail "test-contended is missing from the report.\n" if !defined $cl;
+fail "test-contended acquired $cl->[0] times, expected 4.\n"
+  if $cl->[0] != 4;
+fail "test-contended contended $cl->[1] times, expected 3.\n"
+  if $cl->[1] != 3;
+fail "test-contended shows no wait time.\n" if $cl->[2] == 0;
+
+my ($fl) = $stats{"test-free"};
+fail "test-free is missing from the report.\n" if !defined $fl;
+fail "test-free acquired $fl->[0] times, expected 10.\n"
+  if $fl->[0] != 10;
+fail "test-free contended $fl->[1] times, expected 0.\n" if $fl->[1] != 0;
+fail "test-free shows $fl->[2] cycles of wait, expected 0.\n"
+  if $fl->[2] != 0;
+
+pass;
@@ -0,0 +1,173 @@
+/* Has several threads repeatedly allocate and free blocks of
+   every size that malloc() manages itself, partly one at a time
+   and partly in batches larger than a magazine, so that both the
+   magazine fast path and the depot exchange are exercised.  Checks
+   that no block is handed out twice and reports the malloc/free
+   throughput.
+
+   Then parks a few hundred blocks in the magazines and the
+   depot, takes every page the kernel pool has left with
+   palloc_get_page(), and checks that an arena of the blocks freed
+   last, which sit in a magazine, was among them: the page
+   allocator can only hand one out by having malloc() flush its
+   magazines when the pool runs dry. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "devices/timer.h"
+
+#define THREAD_CNT 4
+#define ROUND_CNT 500
+#define BATCH_CNT 64
+
+/* Blocks parked in magazines before the pool is drained. */
+#define PARK_CNT 512
+#define PARK_SIZE 512
+
+/* Blocks freed last, which are sure to be in a magazine. */
+#define PARK_LAST 16
+
+static thread_func allocator;
+static void check_flush (void);
+static struct semaphore done;
+static volatile int corrupt_cnt;
+
+void
+test_malloc_bench (void) 
+{
+  int64_t start, elapsed, pairs;
+  int i;
+
+  msg ("%d threads will malloc and free %d rounds each.",
+       THREAD_CNT, ROUND_CNT);
+
+  sema_init (&done, 0);
+  corrupt_cnt = 0;
+
+  start = timer_ticks ();
+  for (i = 0; i < THREAD_CNT; i++) 
+    {
+      char name[16];
+      snprintf (name, sizeof name, "allocator %d", i);
+      if (thread_create (name, PRI_DEFAULT, allocator, (void *) (intptr_t) i)
+          == TID_ERROR)
+        fail ("couldn't create thread %d", i);
+    }
+  for (i = 0; i < THREAD_CNT; i++)
+    sema_down (&done);
+  elapsed = timer_elapsed (start);
+
+  if (corrupt_cnt != 0)
+    fail ("%d blocks were overwritten while allocated", corrupt_cnt);
+  msg ("No block was handed out twice.");
+
+  /* Each round is one single pair plus BATCH_CNT batched pairs
+     for each of the 7 block sizes. */
+  pairs = (int64_t) THREAD_CNT * ROUND_CNT * 7 * (1 + BATCH_CNT);
+  msg ("%lld malloc/free pairs in %lld ticks (%lld ns per pair).",
+       pairs, elapsed, elapsed * (1000000000 / TIMER_FREQ) / pairs);
+
+  check_flush ();
+}
+
+/* Fills the magazines and the depot with PARK_SIZE blocks, takes
+   every free kernel page, and looks for the arenas of the last
+   PARK_LAST parked blocks among them. */
+static void
+check_flush (void) 
+{
+  static void *parked[PARK_CNT];
+  void **pages = NULL;
+  bool reclaimed = false;
+  void *p;
+  int i;
+
+  for (i = 0; i < PARK_CNT; i++) 
+    if ((parked[i] = malloc (PARK_SIZE)) == NULL)
+      fail ("malloc (%d) failed", PARK_SIZE);
+  for (i = 0; i < PARK_CNT; i++)
+    free (parked[i]);
+
+  /* Chain the pages through their first word. */
+  while ((p = palloc_get_page (0)) != NULL) 
+    {
+      for (i = PARK_CNT - PARK_LAST; i < PARK_CNT; i++)
+        if (p == pg_round_down (parked[i]))
+          reclaimed = true;
+      *(void **) p = pages;
+      pages = p;
+    }
+
+  if (!reclaimed)
+    fail ("no arena of blocks parked in a magazine was reclaimed");
+  msg ("Parked blocks were flushed when the pool ran dry.");
+
+  while (pages != NULL) 
+    {
+      void **next = *pages;
+      palloc_free_page (pages);
+      pages = next;
+    }
+}
+
+/* Marks the first and last byte of the SIZE-byte block at P with
+   TAG.  The first byte overlaps the free-list link, so a block
+   that is also on a free list or in a magazine gets caught. */
+static void
+stamp (void *p, size_t size, int tag) 
+{
+  unsigned char *q = p;
+  q[0] = q[size - 1] = tag;
+}
+
+/* Checks the marks that stamp() left at P. */
+static void
+check (const void *p, size_t size, int tag) 
+{
+  const unsigned char *q = p;
+  if (q[0] != (unsigned char) tag || q[size - 1] != (unsigned char) tag)
+    corrupt_cnt++;
+}
+
+static void 
+allocator (void *id_) 
+{
+  int tag = (int) (intptr_t) id_ + 1;
+  void *batch[BATCH_CNT];
+  int i, j;
+
+  for (i = 0; i < ROUND_CNT; i++) 
+    {
+      size_t size;
+
+      for (size = 16; size <= 1024; size *= 2) 
+        {
+          void *p = malloc (size);
+          if (p == NULL)
+            fail ("malloc (%zu) failed", size);
+          stamp (p, size, tag);
+          check (p, size, tag);
+          free (p);
+
+          for (j = 0; j < BATCH_CNT; j++) 
+            {
+              batch[j] = malloc (size);
+              if (batch[j] == NULL)
+                fail ("malloc (%zu) failed", size);
+              stamp (batch[j], size, tag);
+            }
+          for (j = 0; j < BATCH_CNT; j++) 
+            {
+              check (batch[j], size, tag);
+              free (batch[j]);
+            }
+        }
+    }
+  sema_up (&done);
+}
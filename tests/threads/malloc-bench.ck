@@ -0,0 +1,30 @@
+# -*- perl -*-
+
+# The expected output looks like this, except that the timing
+# figures vary from run to run:
+#
+# (malloc-bench) begin
+# (malloc-bench) 4 threads will malloc and free 500 rounds each.
+# (malloc-bench) No block was handed out twice.
+# (malloc-bench) 910000 malloc/free pairs in 45 ticks (494 ns per pair).
+# (malloc-bench) Parked blocks were flushed when the pool ran dry.
+# (malloc-bench) end
+
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+fail "A block was handed out twice.\n"
+  if !grep (/No block was handed out twice\./, @output);
+fail "Magazines were not flushed when the page allocator ran dry.\n"
+  if !grep (/Parked blocks were flushed when the pool ran dry\./, @output);
+fail "No throughput report found in output.\n"
+  if !grep (/\d+ malloc\/free pairs in \d+ ticks \(\d+ ns per pair\)\./,
+            @output);
+
+pass;
@@ -0,0 +1,96 @@
+/* Fragments the kernel pool by allocating many single pages and
+   freeing every other one, then times multi-page allocations
+   from it.  For comparison, it times the same requests against a
+   bitmap with the same fragmentation, scanned from the start the
+   way palloc_get_multiple() used to.  Finally it frees everything
+   and checks that the freed pages coalesced into a large block.
+
+   It prints the kernel pool's free blocks by order before
+   fragmenting, while fragmented, and after freeing everything,
+   so that the check script can tell that each hole was a single
+   free page and that freeing restored the blocks exactly. */
+
+#include <bitmap.h>
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
+#include "devices/timer.h"
+
+#define FRAG_CNT 2048
+#define REQ_CNT 20000
+#define REQ_PAGES 4
+#define BIG_PAGES 512
+
+void
+test_palloc_bench (void) 
+{
+  void **pages;
+  struct bitmap *map;
+  int64_t start, buddy_ticks, bitmap_ticks;
+  void *big;
+  int i;
+
+  msg ("Fragmenting the kernel pool with %d single pages.", FRAG_CNT);
+  pages = malloc (sizeof *pages * FRAG_CNT);
+  ASSERT (pages != NULL);
+  map = bitmap_create (FRAG_CNT + REQ_PAGES);
+  ASSERT (map != NULL);
+  palloc_print_stats ();
+  for (i = 0; i < FRAG_CNT; i++) 
+    {
+      pages[i] = palloc_get_page (0);
+      if (pages[i] == NULL)
+        fail ("out of pages after %d", i);
+    }
+  for (i = 1; i < FRAG_CNT; i += 2) 
+    {
+      palloc_free_page (pages[i]);
+      pages[i] = NULL;
+    }
+  palloc_print_stats ();
+
+  /* The old allocator would scan past every hole before finding
+     REQ_PAGES contiguous pages.  Model it with a bitmap. */
+  for (i = 0; i < FRAG_CNT; i += 2)
+    bitmap_mark (map, i);
+
+  start = timer_ticks ();
+  for (i = 0; i < REQ_CNT; i++) 
+    {
+      void *p = palloc_get_multiple (0, REQ_PAGES);
+      if (p == NULL)
+        fail ("palloc_get_multiple (%d) failed", REQ_PAGES);
+      if (pg_ofs (p) != 0)
+        fail ("palloc_get_multiple returned unaligned %p", p);
+      palloc_free_multiple (p, REQ_PAGES);
+    }
+  buddy_ticks = timer_elapsed (start);
+
+  start = timer_ticks ();
+  for (i = 0; i < REQ_CNT; i++) 
+    {
+      size_t idx = bitmap_scan_and_flip (map, 0, REQ_PAGES, false);
+      if (idx == BITMAP_ERROR)
+        fail ("bitmap scan failed");
+      bitmap_set_multiple (map, idx, REQ_PAGES, false);
+    }
+  bitmap_ticks = timer_elapsed (start);
+
+  msg ("%d %d-page requests: buddy %lld ticks, bitmap scan %lld ticks.",
+       REQ_CNT, REQ_PAGES, buddy_ticks, bitmap_ticks);
+
+  for (i = 0; i < FRAG_CNT; i += 2)
+    palloc_free_page (pages[i]);
+  palloc_print_stats ();
+  bitmap_destroy (map);
+  free (pages);
+
+  big = palloc_get_multiple (0, BIG_PAGES);
+  if (big == NULL)
+    fail ("freed pages did not coalesce into %d pages", BIG_PAGES);
+  palloc_free_multiple (big, BIG_PAGES);
+  msg ("Freed pages coalesced into a %d-page block.", BIG_PAGES);
+}
@@ -0,0 +1,65 @@
+# -*- perl -*-
+
+# The expected output looks like this, except that the timing
+# figures and block counts vary from run to run:
+#
+# (palloc-bench) begin
+# (palloc-bench) Fragmenting the kernel pool with 2048 single pages.
+# Palloc: kernel pool 0 zeroed hits, 0 misses; user pool 0 zeroed hits, 0 misses
+# Palloc: kernel pool free blocks by order: 1 1 0 1 ... 3 0 0 0
+# Palloc: kernel pool ...
+# Palloc: kernel pool free blocks by order: 1024 0 0 1 ... 2 0 0 0
+# (palloc-bench) 20000 4-page requests: buddy 3 ticks, bitmap scan 85 ticks.
+# Palloc: kernel pool ...
+# Palloc: kernel pool free blocks by order: 1 1 0 1 ... 3 0 0 0
+# (palloc-bench) Freed pages coalesced into a 512-page block.
+# (palloc-bench) end
+#
+# The same report is printed once more at shutdown.
+
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+my (@blocks) = map (/^Palloc: kernel pool free blocks by order: ([\d ]+)$/,
+                    @output);
+fail "Expected 3 free block reports during the test, found "
+  . scalar (@blocks) . ".\n" if @blocks < 3;
+my ($before, $fragmented, $after) = map ([split (' ', $_)], @blocks[0...2]);
+
+# Fragmenting takes 2048 pages and gives every other one back.
+sub free_pages {
+    my ($blocks) = @_;
+    my ($pages) = 0;
+    $pages += $blocks->[$_] << $_ foreach 0...$#$blocks;
+    return $pages;
+}
+fail "Fragmenting took " . (free_pages ($before) - free_pages ($fragmented))
+  . " free pages, expected 1024.\n"
+  if free_pages ($before) - free_pages ($fragmented) != 1024;
+
+# Each page given back has its buddy still allocated, so each of
+# the 1024 holes is a free block of order 0.  The single free pages
+# that the pool already had may have been used up first.
+fail "Only $fragmented->[0] free single pages after fragmenting, "
+  . "expected at least " . (1024 - $before->[0]) . ".\n"
+  if $fragmented->[0] < 1024 - $before->[0];
+
+# Freeing every page must merge the holes back with their buddies
+# into the blocks the pool had before.
+fail "Free blocks by order were (@$before) before the test "
+  . "but (@$after) after it: freed pages did not coalesce.\n"
+  if "@$before" ne "@$after";
+
+fail "No 512-page block could be allocated after freeing.\n"
+  if !grep (/Freed pages coalesced into a 512-page block\./, @output);
+fail "No timing report found in output.\n"
+  if !grep (/20000 4-page requests: buddy \d+ ticks, bitmap scan \d+ ticks\./,
+            @output);
+
+pass;
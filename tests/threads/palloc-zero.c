@@ -0,0 +1,45 @@
+/* Allocates zeroed pages, dirties and frees them, and sleeps so
+   that the zeroer can refill its stock, several times over.
+   Every page handed out with PAL_ZERO must read back as zeros,
+   whether it came from the stock or was cleared inline. */
+
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
+#include "devices/timer.h"
+
+#define PAGE_CNT 64
+#define ROUND_CNT 4
+
+void
+test_palloc_zero (void) 
+{
+  void *pages[PAGE_CNT];
+  int round, i;
+  size_t j;
+
+  for (round = 0; round < ROUND_CNT; round++) 
+    {
+      for (i = 0; i < PAGE_CNT; i++) 
+        {
+          uint8_t *p = palloc_get_page (PAL_ZERO);
+          if (p == NULL)
+            fail ("out of pages in round %d", round);
+          for (j = 0; j < PGSIZE; j++)
+            if (p[j] != 0)
+              fail ("round %d page %d byte %zu is %#x, not 0",
+                    round, i, j, p[j]);
+          memset (p, 0x5a, PGSIZE);
+          pages[i] = p;
+        }
+      for (i = 0; i < PAGE_CNT; i++)
+        palloc_free_page (pages[i]);
+      msg ("Round %d: %d zeroed pages checked.", round, PAGE_CNT);
+
+      /* Leave the CPU idle for the zeroer. */
+      timer_sleep (10);
+    }
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(palloc-zero) begin
+(palloc-zero) Round 0: 64 zeroed pages checked.
+(palloc-zero) Round 1: 64 zeroed pages checked.
+(palloc-zero) Round 2: 64 zeroed pages checked.
+(palloc-zero) Round 3: 64 zeroed pages checked.
+(palloc-zero) end
+EOF
+pass;
@@ -0,0 +1,168 @@
+/* Two threads, each with its own address space, hand control back
+   and forth through a pair of semaphores, and each touches a set
+   of its own user pages every time it runs.  Measures the cycles
+   per round trip with every switch flushing the TLB, then, if the
+   CPU has them, with PCID-tagged TLB entries kept across switches.
+
+   Each thread stands in for a process: schedule() loads its pml4
+   on every switch exactly as it would a user process's.  Kernels
+   built without USERPROG do not switch address spaces in
+   schedule(), so there the threads do it themselves. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/mmu.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "intrinsic.h"
+
+#define ROUND_CNT 5000
+#define TOUCH_PAGES 64
+
+/* Where each address space's pages are mapped. */
+#define UBASE ((uint8_t *) 0x10000000)
+
+static struct semaphore ping_go, pong_go, pong_done;
+
+static uint64_t *make_space (void);
+static void enter_space (uint64_t *pml4);
+static void leave_space (uint64_t *pml4);
+static void resume_space (uint64_t *pml4);
+static void touch_pages (void);
+static uint64_t measure (void);
+static void pong (void *);
+
+void
+test_pcid_pingpong (void) 
+{
+  bool was_enabled = pcid_enabled;
+
+  msg ("%d round trips touching %d pages each way.",
+       ROUND_CNT, TOUCH_PAGES);
+
+  pcid_enable (false);
+  msg ("Without PCIDs: %llu cycles per round trip.", measure ());
+
+  if (pcid_supported) 
+    {
+      pcid_enable (true);
+      msg ("With PCIDs: %llu cycles per round trip.", measure ());
+      pcid_enable (was_enabled);
+    }
+  else
+    msg ("PCIDs are not supported on this CPU.");
+}
+
+/* Runs ROUND_CNT round trips between this thread and a new one,
+   each in its own address space, and returns the average number
+   of cycles per round trip. */
+static uint64_t
+measure (void) 
+{
+  uint64_t *pml4 = make_space ();
+  uint64_t start, cycles;
+  int i;
+
+  sema_init (&ping_go, 0);
+  sema_init (&pong_go, 0);
+  sema_init (&pong_done, 0);
+  thread_create ("pong", PRI_DEFAULT, pong, NULL);
+
+  enter_space (pml4);
+  start = rdtsc ();
+  for (i = 0; i < ROUND_CNT; i++) 
+    {
+      touch_pages ();
+      sema_up (&pong_go);
+      sema_down (&ping_go);
+      resume_space (pml4);
+    }
+  cycles = rdtsc () - start;
+  leave_space (pml4);
+
+  sema_down (&pong_done);
+  return cycles / ROUND_CNT;
+}
+
+static void
+pong (void *aux UNUSED) 
+{
+  uint64_t *pml4 = make_space ();
+  int i;
+
+  enter_space (pml4);
+  for (i = 0; i < ROUND_CNT; i++) 
+    {
+      sema_down (&pong_go);
+      resume_space (pml4);
+      touch_pages ();
+      sema_up (&ping_go);
+    }
+  leave_space (pml4);
+  sema_up (&pong_done);
+}
+
+/* Returns a new address space with TOUCH_PAGES user pages mapped
+   at UBASE. */
+static uint64_t *
+make_space (void) 
+{
+  uint64_t *pml4 = pml4_create ();
+  int i;
+
+  if (pml4 == NULL)
+    fail ("pml4_create failed");
+  for (i = 0; i < TOUCH_PAGES; i++) 
+    {
+      void *kpage = palloc_get_page (PAL_USER | PAL_ZERO);
+      if (kpage == NULL
+          || !pml4_set_page (pml4, UBASE + i * PGSIZE, kpage, true))
+        fail ("out of memory mapping page %d", i);
+    }
+  return pml4;
+}
+
+/* Makes PML4 the running thread's address space, so that
+   schedule() switches to it like a process's. */
+static void
+enter_space (uint64_t *pml4) 
+{
+#ifdef USERPROG
+  thread_current ()->pml4 = pml4;
+#endif
+  pml4_activate (pml4);
+}
+
+/* Loads PML4 after a switch, unless schedule() already has. */
+static void
+resume_space (uint64_t *pml4 UNUSED) 
+{
+#ifndef USERPROG
+  pml4_activate (pml4);
+#endif
+}
+
+/* Switches back to the kernel-only address space and frees PML4
+   along with its pages. */
+static void
+leave_space (uint64_t *pml4) 
+{
+#ifdef USERPROG
+  thread_current ()->pml4 = NULL;
+#endif
+  pml4_activate (NULL);
+  pml4_destroy (pml4);
+}
+
+/* Reads and writes one word on each user page. */
+static void
+touch_pages (void) 
+{
+  int i;
+
+  for (i = 0; i < TOUCH_PAGES; i++)
+    ((volatile uint64_t *) (UBASE + i * PGSIZE))[0]++;
+}
@@ -0,0 +1,28 @@
+# -*- perl -*-
+
+# The expected output looks like this, except that the cycle
+# counts vary from run to run, and the last report is replaced by
+# "PCIDs are not supported on this CPU." on CPUs without them:
+#
+# (pcid-pingpong) begin
+# (pcid-pingpong) 5000 round trips touching 64 pages each way.
+# (pcid-pingpong) Without PCIDs: 21034 cycles per round trip.
+# (pcid-pingpong) With PCIDs: 9120 cycles per round trip.
+# (pcid-pingpong) end
+
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+fail "No measurement without PCIDs found in output.\n"
+  if !grep (/Without PCIDs: \d+ cycles per round trip\./, @output);
+fail "No measurement with PCIDs found in output.\n"
+  if !grep (/With PCIDs: \d+ cycles per round trip\.|PCIDs are not supported/,
+            @output);
+
+pass;
@@ -0,0 +1,124 @@
+/* The main thread acquires 64 locks and lowers its own priority
+   to the minimum.  Then 64 threads block on each lock, at
+   priorities chosen so that the highest waiter on lock I is
+   MAX_WAITER_PRIORITY (I), which grows with I.  The main thread
+   releases the locks from the highest down, checking after each
+   release that its priority falls to the highest donation still
+   outstanding.  Each lock's waiters must get the lock in
+   priority order. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define LOCK_CNT 64
+#define WAITER_CNT 64
+
+/* Highest priority among the waiters on lock I. */
+#define MAX_WAITER_PRIORITY(I) (PRI_MIN + 2 + (I) * (PRI_MAX - PRI_MIN - 3) / (LOCK_CNT - 1))
+
+struct waiter 
+  {
+    int lock_idx;               /* Lock to wait on. */
+    int priority;               /* Base priority. */
+  };
+
+static thread_func waiter_thread_func;
+
+static struct lock locks[LOCK_CNT];
+static int last_priority[LOCK_CNT];
+static int order_errors;
+static int done_cnt;
+
+void
+test_priority_donate_many (void) 
+{
+  struct waiter *waiters;
+  int priority_errors = 0;
+  int i, j;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  msg ("%d threads will wait on each of %d locks.", WAITER_CNT, LOCK_CNT);
+
+  waiters = malloc (sizeof *waiters * LOCK_CNT * WAITER_CNT);
+  ASSERT (waiters != NULL);
+  order_errors = done_cnt = 0;
+
+  for (i = 0; i < LOCK_CNT; i++) 
+    {
+      lock_init (&locks[i]);
+      lock_acquire (&locks[i]);
+      last_priority[i] = PRI_MAX + 1;
+    }
+  thread_set_priority (PRI_MIN);
+
+  for (i = 0; i < LOCK_CNT; i++)
+    for (j = 0; j < WAITER_CNT; j++) 
+      {
+        struct waiter *w = &waiters[i * WAITER_CNT + j];
+        char name[16];
+
+        /* Cycles through every priority from PRI_MIN + 1 up to
+           MAX_WAITER_PRIORITY (I). */
+        w->lock_idx = i;
+        w->priority = PRI_MIN + 1 + (i + j) % (MAX_WAITER_PRIORITY (i) - PRI_MIN);
+        snprintf (name, sizeof name, "waiter %d.%d", i, j);
+        if (thread_create (name, w->priority, waiter_thread_func, w)
+            == TID_ERROR)
+          fail ("couldn't create thread %s", name);
+      }
+
+  /* Let every waiter that did not preempt us run and block. */
+  for (i = 0; i < LOCK_CNT; i++)
+    while (heap_size (&locks[i].semaphore.waiters) != WAITER_CNT)
+      timer_sleep (1);
+
+  for (i = LOCK_CNT - 1; i >= 0; i--) 
+    {
+      int expected = i > 0 ? MAX_WAITER_PRIORITY (i - 1) : PRI_MIN;
+
+      if (thread_get_priority () != MAX_WAITER_PRIORITY (i))
+        priority_errors++;
+      lock_release (&locks[i]);
+      if (thread_get_priority () != expected)
+        priority_errors++;
+    }
+  if (priority_errors != 0)
+    fail ("main thread had the wrong priority %d times", priority_errors);
+  msg ("Priority was correct around all %d releases.", LOCK_CNT);
+
+  /* All the waiters are above our priority now, so they have
+     all finished by the time we run again. */
+  if (done_cnt != LOCK_CNT * WAITER_CNT)
+    fail ("only %d of %d waiters finished", done_cnt, LOCK_CNT * WAITER_CNT);
+  if (order_errors != 0)
+    fail ("%d waiters got their lock out of priority order", order_errors);
+  msg ("All %d waiters got their locks in priority order.",
+       LOCK_CNT * WAITER_CNT);
+
+  thread_set_priority (PRI_DEFAULT);
+  free (waiters);
+}
+
+static void
+waiter_thread_func (void *w_) 
+{
+  struct waiter *w = w_;
+  struct lock *lock = &locks[w->lock_idx];
+
+  lock_acquire (lock);
+  if (w->priority > last_priority[w->lock_idx])
+    order_errors++;
+  last_priority[w->lock_idx] = w->priority;
+  done_cnt++;
+  lock_release (lock);
+}
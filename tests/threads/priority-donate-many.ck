@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(priority-donate-many) begin
+(priority-donate-many) 64 threads will wait on each of 64 locks.
+(priority-donate-many) Priority was correct around all 64 releases.
+(priority-donate-many) All 4096 waiters got their locks in priority order.
+(priority-donate-many) end
+EOF
+pass;
@@ -0,0 +1,104 @@
+/* Puts several hundred threads on the ready queue at once, spread
+   over a few priorities, and has each of them yield a fixed number
+   of times.  Checks that the groups ran from the highest priority
+   down and that the threads of each group took turns in the order
+   they were created, then reports the average cost of a context
+   switch with that many runnable threads, which should not grow with
+   the number of ready threads. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/thread.h"
+#include "intrinsic.h"
+
+#define THREAD_CNT 512
+#define PRIORITY_CNT 4
+#define YIELD_CNT 16
+
+static thread_func yield_thread_func;
+
+/* IDs of the workers, in the order they ran. */
+static int *run_order;
+static int run_cnt;
+
+void
+test_priority_many_ready (void) 
+{
+  int *ids;
+  int group_size = THREAD_CNT / PRIORITY_CNT;
+  uint64_t start, cycles;
+  int i, p, round, pos;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  msg ("%d threads at %d priorities will yield %d times each.",
+       THREAD_CNT, PRIORITY_CNT, YIELD_CNT);
+
+  ids = malloc (sizeof *ids * THREAD_CNT);
+  run_order = malloc (sizeof *run_order * THREAD_CNT * YIELD_CNT);
+  ASSERT (ids != NULL && run_order != NULL);
+  run_cnt = 0;
+
+  /* Keep the workers from running until all of them are ready.
+     Thread I goes into group I % PRIORITY_CNT, whose priority is
+     PRI_DEFAULT + 1 + I % PRIORITY_CNT. */
+  thread_set_priority (PRI_DEFAULT + PRIORITY_CNT + 1);
+  for (i = 0; i < THREAD_CNT; i++) 
+    {
+      char name[16];
+      snprintf (name, sizeof name, "yield %d", i);
+      ids[i] = i;
+      if (thread_create (name, PRI_DEFAULT + 1 + i % PRIORITY_CNT,
+                         yield_thread_func, &ids[i]) == TID_ERROR)
+        fail ("couldn't create thread %d", i);
+    }
+
+  start = rdtsc ();
+  thread_set_priority (PRI_DEFAULT);
+  /* All the other threads now run to termination here. */
+  cycles = rdtsc () - start;
+
+  if (run_cnt != THREAD_CNT * YIELD_CNT)
+    fail ("workers ran %d times instead of %d",
+          run_cnt, THREAD_CNT * YIELD_CNT);
+
+  /* The highest group must finish before the next one starts, and
+     every round of a group must follow creation order. */
+  pos = 0;
+  for (p = PRIORITY_CNT - 1; p >= 0; p--)
+    for (round = 0; round < YIELD_CNT; round++)
+      for (i = 0; i < group_size; i++, pos++)
+        if (run_order[pos] != i * PRIORITY_CNT + p)
+          fail ("run %d was thread %d, expected thread %d",
+                pos, run_order[pos], i * PRIORITY_CNT + p);
+  msg ("Groups ran highest priority first, round-robin within each.");
+
+  msg ("%d context switches, %llu cycles per switch.",
+       run_cnt, cycles / run_cnt);
+  free (run_order);
+  free (ids);
+}
+
+/* Runs with interrupts off, so that the only way off the CPU is the
+   thread_yield() right after recording the turn; a time slice
+   expiring in between would reorder the round-robin. */
+static void 
+yield_thread_func (void *id_) 
+{
+  int id = *(int *) id_;
+  int i;
+
+  intr_disable ();
+  for (i = 0; i < YIELD_CNT; i++) 
+    {
+      run_order[run_cnt++] = id;
+      thread_yield ();
+    }
+}
@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+# The cycle count in the last report depends on the host.
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+fail "Workers did not run in priority and round-robin order.\n"
+  if !grep (/Groups ran highest priority first, round-robin within each\./,
+            @output);
+fail "No context switch report found in output.\n"
+  if !grep (/\d+ context switches, \d+ cycles per switch\./, @output);
+
+pass;
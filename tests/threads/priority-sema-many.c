@@ -0,0 +1,115 @@
+/* Has many threads of mixed priority wait on one semaphore.
+   While they wait, a quarter of them receive a donation through
+   a lock they hold, which has to move them up in the semaphore's
+   waiters.  Prints how many waiters woke up at each priority, in
+   wakeup order, so that the checker can tell whether sema_up()
+   woke them in order of their current priority, and reports how
+   long the wakeups took. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define WAITER_CNT 1024
+#define DONATE_EVERY 4
+
+struct waiter
+  {
+    struct lock lock;           /* Held while waiting, for donation. */
+  };
+
+static thread_func waiter_thread;
+static thread_func donor_thread;
+static struct semaphore sema;
+static int wake_order[WAITER_CNT];
+static int wake_cnt;
+
+void
+test_priority_sema_many (void) 
+{
+  struct waiter *waiters;
+  int64_t start, elapsed;
+  int i, j;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  msg ("%d threads will wait on one semaphore, %d of them with "
+       "donated priority.", WAITER_CNT, WAITER_CNT / DONATE_EVERY);
+
+  waiters = malloc (sizeof *waiters * WAITER_CNT);
+  ASSERT (waiters != NULL);
+  sema_init (&sema, 0);
+  wake_cnt = 0;
+
+  /* Each waiter is above our priority, so it runs as soon as it
+     is created and blocks on SEMA before we continue. */
+  for (i = 0; i < WAITER_CNT; i++) 
+    {
+      int priority = PRI_DEFAULT + 1 + i * 7 % (PRI_MAX - PRI_DEFAULT - 1);
+      char name[16];
+
+      lock_init (&waiters[i].lock);
+      snprintf (name, sizeof name, "waiter %d", i);
+      if (thread_create (name, priority, waiter_thread, &waiters[i])
+          == TID_ERROR)
+        fail ("couldn't create waiter %d", i);
+    }
+
+  /* Each donor blocks on a waiter's lock, raising that waiter to
+     PRI_MAX while it sits in SEMA's waiters. */
+  for (i = 0; i < WAITER_CNT; i += DONATE_EVERY) 
+    {
+      char name[16];
+
+      snprintf (name, sizeof name, "donor %d", i);
+      if (thread_create (name, PRI_MAX, donor_thread, &waiters[i])
+          == TID_ERROR)
+        fail ("couldn't create donor %d", i);
+    }
+
+  /* Every wakeup preempts us, so the waiter records its priority
+     before the next sema_up(). */
+  start = timer_ticks ();
+  for (i = 0; i < WAITER_CNT; i++)
+    sema_up (&sema);
+  elapsed = timer_elapsed (start);
+
+  if (wake_cnt != WAITER_CNT)
+    fail ("only %d of %d waiters woke up", wake_cnt, WAITER_CNT);
+  for (i = 0; i < WAITER_CNT; i = j)
+    {
+      for (j = i; j < WAITER_CNT && wake_order[j] == wake_order[i]; j++)
+        continue;
+      msg ("%d woke up at priority %d.", j - i, wake_order[i]);
+    }
+
+  msg ("%d wakeups in %lld ticks (%lld ns per wakeup).",
+       WAITER_CNT, elapsed,
+       elapsed * (1000000000 / TIMER_FREQ) / WAITER_CNT);
+  free (waiters);
+}
+
+static void
+waiter_thread (void *w_) 
+{
+  struct waiter *w = w_;
+
+  lock_acquire (&w->lock);
+  sema_down (&sema);
+  wake_order[wake_cnt++] = thread_get_priority ();
+  lock_release (&w->lock);
+}
+
+static void
+donor_thread (void *w_) 
+{
+  struct waiter *w = w_;
+
+  lock_acquire (&w->lock);
+  lock_release (&w->lock);
+}
@@ -0,0 +1,56 @@
+# -*- perl -*-
+
+# The test prints how many waiters woke up at each priority, in the
+# order they woke up, then a timing line that varies from run to run:
+#
+# (priority-sema-many) begin
+# (priority-sema-many) 1024 threads will wait on one semaphore, 256 of them with donated priority.
+# (priority-sema-many) 256 woke up at priority 63.
+# (priority-sema-many) 25 woke up at priority 62.
+# ...
+# (priority-sema-many) 25 woke up at priority 32.
+# (priority-sema-many) 1024 wakeups in 3 ticks (300 ns per wakeup).
+# (priority-sema-many) end
+#
+# Waiter I has priority 32 + I * 7 % 31, except that every fourth
+# waiter is raised to 63 by donation, so the expected count at each
+# priority is computed the same way here.
+
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+my (%expected);
+for my $i (0...1023) {
+    $expected{$i % 4 == 0 ? 63 : 32 + $i * 7 % 31}++;
+}
+
+my (@woke) = map (/(\d+) woke up at priority (\d+)\./ ? [$1, $2] : (),
+                  @output);
+fail "No wakeups reported.\n" if !@woke;
+
+my ($last);
+foreach my $run (@woke) {
+    my ($cnt, $priority) = @$run;
+    fail "Priority $priority woke up after priority $last.\n"
+      if defined $last && $priority >= $last;
+    fail "Priority $priority woke up but no waiter has it.\n"
+      if !defined $expected{$priority};
+    fail "$cnt waiters woke up at priority $priority, "
+      . "expected $expected{$priority}.\n"
+      if $cnt != $expected{$priority};
+    delete $expected{$priority};
+    $last = $priority;
+}
+fail "No waiters woke up at priority " . join (", ", sort keys %expected)
+  . ".\n" if %expected;
+
+fail "No wakeup timing found in output.\n"
+  if !grep (/1024 wakeups in \d+ ticks \(\d+ ns per wakeup\)\./, @output);
+
+pass;
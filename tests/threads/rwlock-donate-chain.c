@@ -0,0 +1,65 @@
+/* The main thread holds a reader-writer lock exclusively.  A
+   "medium" thread takes a plain lock and then blocks reading the
+   rwlock, and a "high" thread blocks on the plain lock.  The
+   priority of "high" must reach the main thread through
+   "medium" and the rwlock (nested donation). */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func medium_thread_func;
+static thread_func high_thread_func;
+
+static struct rwlock rwlock;
+static struct lock lock;
+
+void
+test_rwlock_donate_chain (void) 
+{
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  rwlock_init (&rwlock);
+  lock_init (&lock);
+
+  rwlock_acquire_write (&rwlock);
+  thread_create ("medium", PRI_DEFAULT + 1, medium_thread_func, NULL);
+  msg ("main should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 1, thread_get_priority ());
+
+  thread_create ("high", PRI_DEFAULT + 2, high_thread_func, NULL);
+  msg ("main should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 2, thread_get_priority ());
+
+  rwlock_release_write (&rwlock);
+  msg ("main should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT, thread_get_priority ());
+}
+
+static void
+medium_thread_func (void *aux UNUSED) 
+{
+  lock_acquire (&lock);
+  rwlock_acquire_read (&rwlock);
+  msg ("medium: got the rwlock with priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 2, thread_get_priority ());
+  rwlock_release_read (&rwlock);
+  lock_release (&lock);
+  msg ("medium: should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 1, thread_get_priority ());
+}
+
+static void
+high_thread_func (void *aux UNUSED) 
+{
+  lock_acquire (&lock);
+  msg ("high: got the lock");
+  lock_release (&lock);
+  msg ("high: done");
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock-donate-chain) begin
+(rwlock-donate-chain) main should have priority 32.  Actual priority: 32.
+(rwlock-donate-chain) main should have priority 33.  Actual priority: 33.
+(rwlock-donate-chain) medium: got the rwlock with priority 33.  Actual priority: 33.
+(rwlock-donate-chain) high: got the lock
+(rwlock-donate-chain) high: done
+(rwlock-donate-chain) medium: should have priority 32.  Actual priority: 32.
+(rwlock-donate-chain) main should have priority 31.  Actual priority: 31.
+(rwlock-donate-chain) end
+EOF
+pass;
@@ -0,0 +1,63 @@
+/* The main thread and a "reader" thread both hold a reader-writer
+   lock shared.  A higher-priority "writer" thread then blocks
+   trying to take it exclusively, which must donate its priority
+   to both readers.  Once both readers have released the lock,
+   the writer gets it and the readers are back to their own
+   priorities. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func reader_thread_func;
+static thread_func writer_thread_func;
+
+static struct rwlock rwlock;
+static struct semaphore reader_sema;
+
+void
+test_rwlock_donate_readers (void) 
+{
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  rwlock_init (&rwlock);
+  sema_init (&reader_sema, 0);
+
+  rwlock_acquire_read (&rwlock);
+  thread_create ("reader", PRI_DEFAULT + 1, reader_thread_func, NULL);
+  thread_create ("writer", PRI_DEFAULT + 3, writer_thread_func, NULL);
+  msg ("main should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 3, thread_get_priority ());
+
+  sema_up (&reader_sema);
+  rwlock_release_read (&rwlock);
+  msg ("main should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT, thread_get_priority ());
+}
+
+static void
+reader_thread_func (void *aux UNUSED) 
+{
+  rwlock_acquire_read (&rwlock);
+  sema_down (&reader_sema);
+  msg ("reader: should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 3, thread_get_priority ());
+  rwlock_release_read (&rwlock);
+  msg ("reader: should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 1, thread_get_priority ());
+}
+
+static void
+writer_thread_func (void *aux UNUSED) 
+{
+  rwlock_acquire_write (&rwlock);
+  msg ("writer: got the lock");
+  rwlock_release_write (&rwlock);
+  msg ("writer: done");
+}
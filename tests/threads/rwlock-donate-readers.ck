@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock-donate-readers) begin
+(rwlock-donate-readers) main should have priority 34.  Actual priority: 34.
+(rwlock-donate-readers) reader: should have priority 34.  Actual priority: 34.
+(rwlock-donate-readers) writer: got the lock
+(rwlock-donate-readers) writer: done
+(rwlock-donate-readers) reader: should have priority 32.  Actual priority: 32.
+(rwlock-donate-readers) main should have priority 31.  Actual priority: 31.
+(rwlock-donate-readers) end
+EOF
+pass;
@@ -0,0 +1,57 @@
+/* The main thread holds a reader-writer lock shared.  A "writer"
+   thread blocks taking it exclusively, then a higher-priority
+   "reader" arrives.  Because a writer is already waiting, the
+   reader must wait too rather than join the main thread, but it
+   still donates its priority to the main thread and, once the
+   writer is granted the lock, to the writer. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func reader_thread_func;
+static thread_func writer_thread_func;
+
+static struct rwlock rwlock;
+
+void
+test_rwlock_writer_pref (void) 
+{
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  rwlock_init (&rwlock);
+
+  rwlock_acquire_read (&rwlock);
+  thread_create ("writer", PRI_DEFAULT + 1, writer_thread_func, NULL);
+  thread_create ("reader", PRI_DEFAULT + 2, reader_thread_func, NULL);
+  msg ("main should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 2, thread_get_priority ());
+
+  rwlock_release_read (&rwlock);
+  msg ("The writer must have had the lock before the reader.");
+}
+
+static void
+reader_thread_func (void *aux UNUSED) 
+{
+  rwlock_acquire_read (&rwlock);
+  msg ("reader: got the lock");
+  rwlock_release_read (&rwlock);
+  msg ("reader: done");
+}
+
+static void
+writer_thread_func (void *aux UNUSED) 
+{
+  rwlock_acquire_write (&rwlock);
+  msg ("writer: should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 2, thread_get_priority ());
+  rwlock_release_write (&rwlock);
+  msg ("writer: done");
+}
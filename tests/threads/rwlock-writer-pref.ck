@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock-writer-pref) begin
+(rwlock-writer-pref) main should have priority 33.  Actual priority: 33.
+(rwlock-writer-pref) writer: should have priority 33.  Actual priority: 33.
+(rwlock-writer-pref) reader: got the lock
+(rwlock-writer-pref) reader: done
+(rwlock-writer-pref) writer: done
+(rwlock-writer-pref) The writer must have had the lock before the reader.
+(rwlock-writer-pref) end
+EOF
+pass;
@@ -17,6 +17,8 @@ static const struct test tests[] =
     {"alarm-priority", test_alarm_priority},
     {"alarm-zero", test_alarm_zero},
     {"alarm-negative", test_alarm_negative},
+    {"alarm-stress", test_alarm_stress},
+    {"alarm-tickless", test_alarm_tickless},
     {"priority-change", test_priority_change},
     {"priority-donate-one", test_priority_donate_one},
     {"priority-donate-multiple", test_priority_donate_multiple},
@@ -25,10 +27,25 @@ static const struct test tests[] =
     {"priority-donate-sema", test_priority_donate_sema},
     {"priority-donate-lower", test_priority_donate_lower},
     {"priority-donate-chain", test_priority_donate_chain},
+    {"priority-donate-many", test_priority_donate_many},
     {"priority-fifo", test_priority_fifo},
     {"priority-preempt", test_priority_preempt},
     {"priority-sema", test_priority_sema},
+    {"priority-sema-many", test_priority_sema_many},
     {"priority-condvar", test_priority_condvar},
+    {"priority-many-ready", test_priority_many_ready},
+    {"latency-histogram", test_latency_histogram},
+    {"lock-contention", test_lock_contention},
+    {"lock-profile", test_lock_profile},
+    {"rwlock-donate-readers", test_rwlock_donate_readers},
+    {"rwlock-donate-chain", test_rwlock_donate_chain},
+    {"rwlock-writer-pref", test_rwlock_writer_pref},
+    {"malloc-bench", test_malloc_bench},
+    {"kmem-cache-reuse", test_kmem_cache_reuse},
+    {"palloc-bench", test_palloc_bench},
+    {"palloc-zero", test_palloc_zero},
+    {"large-pages", test_large_pages},
+    {"pcid-pingpong", test_pcid_pingpong},
     {"mlfqs-load-1", test_mlfqs_load_1},
     {"mlfqs-load-60", test_mlfqs_load_60},
     {"mlfqs-load-avg", test_mlfqs_load_avg},
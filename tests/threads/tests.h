@@ -11,6 +11,8 @@ extern test_func test_alarm_simultaneous;
 extern test_func test_alarm_priority;
 extern test_func test_alarm_zero;
 extern test_func test_alarm_negative;
+extern test_func test_alarm_stress;
+extern test_func test_alarm_tickless;
 extern test_func test_priority_change;
 extern test_func test_priority_donate_one;
 extern test_func test_priority_donate_multiple;
@@ -19,10 +21,25 @@ extern test_func test_priority_donate_sema;
 extern test_func test_priority_donate_nest;
 extern test_func test_priority_donate_lower;
 extern test_func test_priority_donate_chain;
+extern test_func test_priority_donate_many;
 extern test_func test_priority_fifo;
 extern test_func test_priority_preempt;
 extern test_func test_priority_sema;
+extern test_func test_priority_sema_many;
 extern test_func test_priority_condvar;
+extern test_func test_priority_many_ready;
+extern test_func test_latency_histogram;
+extern test_func test_lock_contention;
+extern test_func test_lock_profile;
+extern test_func test_rwlock_donate_readers;
+extern test_func test_rwlock_donate_chain;
+extern test_func test_rwlock_writer_pref;
+extern test_func test_malloc_bench;
+extern test_func test_kmem_cache_reuse;
+extern test_func test_palloc_bench;
+extern test_func test_palloc_zero;
+extern test_func test_large_pages;
+extern test_func test_pcid_pingpong;
 extern test_func test_mlfqs_load_1;
 extern test_func test_mlfqs_load_60;
 extern test_func test_mlfqs_load_avg;
@@ -0,0 +1,21 @@
+/* Checks that futex_wait() returns -1 at once, without sleeping,
+   whenever the int no longer holds the value the caller expects,
+   and that such a call leaves no sleeper behind for futex_wake()
+   to find. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static int word;
+
+void
+test_main (void) 
+{
+  word = 5;
+  CHECK (futex_wait (&word, 4) == -1, "wait for 4 on 5 returns -1");
+  CHECK (futex_wait (&word, -5) == -1, "wait for -5 on 5 returns -1");
+  word = 0;
+  CHECK (futex_wait (&word, 5) == -1, "wait for 5 on 0 returns -1");
+  CHECK (futex_wake (&word, 3) == 0, "no sleeper was left behind");
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(futex-mismatch) begin
+(futex-mismatch) wait for 4 on 5 returns -1
+(futex-mismatch) wait for -5 on 5 returns -1
+(futex-mismatch) wait for 5 on 0 returns -1
+(futex-mismatch) no sleeper was left behind
+(futex-mismatch) end
+futex-mismatch: exit(0)
+EOF
+pass;
@@ -0,0 +1,36 @@
+/* Exercises futex_wait() and futex_wake() and the user-space mutex
+   built on them, without any other thread to contend with. */
+
+#include <mutex.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static int word;
+
+void
+test_main (void) 
+{
+  struct mutex m;
+
+  word = 1;
+  CHECK (futex_wait (&word, 0) == -1, "wait on changed value returns -1");
+  CHECK (futex_wait ((int *) ((char *) &word + 1), 1) == -1,
+         "wait on misaligned int returns -1");
+  CHECK (futex_wake (&word, 1) == 0, "wake with no waiters wakes 0");
+
+  mutex_init (&m);
+  mutex_lock (&m);
+  CHECK (m.state == 1, "uncontended lock");
+  CHECK (!mutex_trylock (&m), "trylock of held mutex fails");
+  mutex_unlock (&m);
+  CHECK (m.state == 0, "uncontended unlock");
+
+  /* Pretend a waiter marked the mutex; unlock must still release
+     it, going through futex_wake(). */
+  mutex_lock (&m);
+  m.state = 2;
+  mutex_unlock (&m);
+  CHECK (m.state == 0 && mutex_trylock (&m), "contended unlock");
+  mutex_unlock (&m);
+}
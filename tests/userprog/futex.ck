@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(futex) begin
+(futex) wait on changed value returns -1
+(futex) wait on misaligned int returns -1
+(futex) wake with no waiters wakes 0
+(futex) uncontended lock
+(futex) trylock of held mutex fails
+(futex) uncontended unlock
+(futex) contended unlock
+(futex) end
+futex: exit(0)
+EOF
+pass;
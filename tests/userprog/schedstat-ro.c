@@ -0,0 +1,14 @@
+/* Passes a read-only buffer, this program's own code, to the
+   schedstat system call.  The process must be terminated with
+   -1 exit code instead of faulting in the kernel. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  schedstat ((struct schedstat *) test_main);
+  fail ("should not have survived schedstat()");
+}
@@ -0,0 +1,23 @@
+/* Reads this process's scheduler statistics and checks that its
+   run time advances while it spins. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct schedstat before, after;
+
+  schedstat (&before);
+  CHECK (before.run_ticks >= 0 && before.ready_ticks >= 0
+         && before.voluntary_switches >= 0
+         && before.involuntary_switches >= 0,
+         "read statistics");
+
+  do
+    schedstat (&after);
+  while (after.run_ticks == before.run_ticks);
+  CHECK (after.run_ticks > before.run_ticks, "run time advanced");
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(schedstat) begin
+(schedstat) read statistics
+(schedstat) run time advanced
+(schedstat) end
+schedstat: exit(0)
+EOF
+pass;
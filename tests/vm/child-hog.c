@@ -0,0 +1,23 @@
+/* Child process of swap-readahead.
+   Touches 8 MB of memory, more than the machine has, so that
+   every page its parent left in memory is swapped out. */
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+const char *test_name = "child-hog";
+
+#define PAGE_SIZE 4096
+#define SIZE (8 * 1024 * 1024)
+static char buf[SIZE];
+
+int
+main (void)
+{
+  size_t i;
+
+  for (i = 0; i < SIZE; i += PAGE_SIZE)
+    buf[i] = 1;
+
+  return 0x42;
+}
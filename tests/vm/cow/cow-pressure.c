@@ -0,0 +1,60 @@
+/* Fills 6 MB, more than the user pool of a 10 MB machine holds,
+   and forks.  Almost every frame the child inherits is then
+   shared with the parent, so the kernel can only make room by
+   swapping shared frames out.  The child reads every page and
+   overwrites half of them; the parent then checks that all of
+   its own pages are intact. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define SIZE (6 * 1024 * 1024)
+#define PAGE_CNT (SIZE / PAGE_SIZE)
+
+static char buf[PAGE_CNT][PAGE_SIZE] __attribute__ ((aligned (4096)));
+
+/* Fails unless every byte of page I is VALUE. */
+static void
+check_page (const char *who, int i, char value)
+{
+  int ofs;
+
+  for (ofs = 0; ofs < PAGE_SIZE; ofs++)
+    if (buf[i][ofs] != value)
+      fail ("%s: byte %d of page %d is %d, not %d",
+            who, ofs, i, buf[i][ofs], value);
+}
+
+void
+test_main (void)
+{
+  pid_t child;
+  int i;
+
+  for (i = 0; i < PAGE_CNT; i++)
+    memset (buf[i], i, PAGE_SIZE);
+  msg ("fill 6 MB");
+
+  child = fork ("child");
+  if (child == 0)
+    {
+      for (i = 0; i < PAGE_CNT; i++)
+        check_page ("child", i, i);
+      msg ("child read every page");
+
+      for (i = 0; i < PAGE_CNT; i += 2)
+        memset (buf[i], ~i, PAGE_SIZE);
+      for (i = 0; i < PAGE_CNT; i++)
+        check_page ("child", i, i % 2 == 0 ? ~i : i);
+      msg ("child overwrote every other page");
+      exit (81);
+    }
+
+  CHECK (wait (child) == 81, "wait for child");
+  for (i = 0; i < PAGE_CNT; i++)
+    check_page ("parent", i, i);
+  msg ("parent's pages are intact");
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(cow-pressure) begin
+(cow-pressure) fill 6 MB
+(cow-pressure) child read every page
+(cow-pressure) child overwrote every other page
+(cow-pressure) wait for child
+(cow-pressure) parent's pages are intact
+(cow-pressure) end
+EOF
+pass;
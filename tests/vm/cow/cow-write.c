@@ -0,0 +1,62 @@
+/* Forks while 16 pages are shared copy-on-write, then has both
+   parent and child overwrite every one of them.  Whichever side
+   writes a page first must get a copy of its own, and the other
+   side then keeps the original frame; each must see only its own
+   writes. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_CNT 16
+
+static char buf[PAGE_CNT][PAGE_SIZE] __attribute__ ((aligned (4096)));
+
+/* Sets every byte of page I to I + DELTA. */
+static void
+fill_pages (int delta)
+{
+  int i;
+
+  for (i = 0; i < PAGE_CNT; i++)
+    memset (buf[i], i + delta, PAGE_SIZE);
+}
+
+/* Fails unless every byte of page I is I + DELTA. */
+static void
+check_pages (const char *who, int delta)
+{
+  int i, ofs;
+
+  for (i = 0; i < PAGE_CNT; i++)
+    for (ofs = 0; ofs < PAGE_SIZE; ofs++)
+      if (buf[i][ofs] != (char) (i + delta))
+        fail ("%s: byte %d of page %d is %d, not %d",
+              who, ofs, i, buf[i][ofs], (char) (i + delta));
+}
+
+void
+test_main (void)
+{
+  pid_t child;
+
+  fill_pages (0);
+  msg ("fill the pages to share");
+
+  child = fork ("child");
+  if (child == 0)
+    {
+      check_pages ("child", 0);
+      fill_pages (100);
+      check_pages ("child", 100);
+      msg ("child sees only its own writes");
+      exit (81);
+    }
+
+  fill_pages (50);
+  CHECK (wait (child) == 81, "wait for child");
+  check_pages ("parent", 50);
+  msg ("parent sees only its own writes");
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(cow-write) begin
+(cow-write) fill the pages to share
+(cow-write) child sees only its own writes
+(cow-write) wait for child
+(cow-write) parent sees only its own writes
+(cow-write) end
+EOF
+pass;
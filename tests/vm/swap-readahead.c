@@ -0,0 +1,41 @@
+/* Fills 2 MB of memory, runs child-hog to push all of it out to
+   swap, and then reads it back in order.  By then the child has
+   exited and freed its frames, so each swap-in should read the
+   neighbouring pages ahead and the faults on them should find
+   them already in memory. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define SIZE (2 * 1024 * 1024)
+#define PAGE_COUNT (SIZE / PAGE_SIZE)
+
+static char buf[SIZE];
+
+void
+test_main (void)
+{
+  size_t page, ofs;
+  pid_t child;
+
+  msg ("fill");
+  for (page = 0; page < PAGE_COUNT; page++)
+    for (ofs = 0; ofs < PAGE_SIZE; ofs++)
+      buf[page * PAGE_SIZE + ofs] = page;
+
+  child = fork ("child-hog");
+  if (child == 0)
+    {
+      if (exec ("child-hog") == -1)
+        fail ("failed to exec child-hog");
+    }
+  CHECK (wait (child) == 0x42, "wait for child-hog");
+
+  msg ("read back in order");
+  for (page = 0; page < PAGE_COUNT; page++)
+    for (ofs = 0; ofs < PAGE_SIZE; ofs++)
+      if (buf[page * PAGE_SIZE + ofs] != (char) page)
+        fail ("byte %zu of page %zu is wrong", ofs, page);
+}
@@ -0,0 +1,30 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+# Besides the test's own messages, checks the read-ahead counts in the
+# swap statistics printed at shutdown, which look like this:
+#
+# Swap: 64 pages in, 1536 pages out, 448 read ahead (448 used), 0 of 3840 slots in use
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(swap-readahead) begin
+(swap-readahead) fill
+(swap-readahead) wait for child-hog
+(swap-readahead) read back in order
+(swap-readahead) end
+EOF
+
+my ($swap) = grep (/^Swap: /, @output);
+fail "No swap statistics found in output.\n" if !defined $swap;
+my ($ahead, $used) = $swap =~ /, (\d+) read ahead \((\d+) used\),/
+  or fail "Malformed swap statistics: $swap\n";
+fail "No pages were read ahead.\n" if $ahead == 0;
+fail "None of the pages read ahead were used.\n" if $used == 0;
+fail "More pages were used ($used) than read ahead ($ahead).\n"
+  if $used > $ahead;
+pass;
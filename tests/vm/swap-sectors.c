@@ -0,0 +1,42 @@
+/* Fills 16 MB of anonymous memory, far more than fits in the
+   10 MB machine, with a pattern that differs in every sector of
+   every page, then reads it all back.  A page written to or read
+   from its swap slot with sectors out of order, or only partly,
+   fails the check. */
+
+#include <stdint.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define SECTOR_SIZE 512
+#define SIZE (16 * 1024 * 1024)
+#define PAGE_COUNT (SIZE / PAGE_SIZE)
+
+static uint8_t buf[SIZE];
+
+/* The byte expected at OFS within page PAGE. */
+static uint8_t
+pattern (size_t page, size_t ofs)
+{
+  return page * 8 + ofs / SECTOR_SIZE + ofs % SECTOR_SIZE;
+}
+
+void
+test_main (void)
+{
+  size_t page, ofs;
+
+  msg ("write pass");
+  for (page = 0; page < PAGE_COUNT; page++)
+    for (ofs = 0; ofs < PAGE_SIZE; ofs++)
+      buf[page * PAGE_SIZE + ofs] = pattern (page, ofs);
+
+  msg ("read pass");
+  for (page = 0; page < PAGE_COUNT; page++)
+    for (ofs = 0; ofs < PAGE_SIZE; ofs++)
+      if (buf[page * PAGE_SIZE + ofs] != pattern (page, ofs))
+        fail ("page %zu, sector %zu, byte %zu: %#x != %#x",
+              page, ofs / SECTOR_SIZE, ofs % SECTOR_SIZE,
+              buf[page * PAGE_SIZE + ofs], pattern (page, ofs));
+}
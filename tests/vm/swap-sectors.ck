@@ -0,0 +1,30 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+# Besides the test's own messages, checks the swap statistics printed
+# at shutdown, which look like this:
+#
+# Swap: 4096 pages in, 6144 pages out, 0 read ahead (0 used), 0 of 3840 slots in use
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(swap-sectors) begin
+(swap-sectors) write pass
+(swap-sectors) read pass
+(swap-sectors) end
+EOF
+
+my ($swap) = grep (/^Swap: /, @output);
+fail "No swap statistics found in output.\n" if !defined $swap;
+my ($in, $out, $used) = $swap
+  =~ /^Swap: (\d+) pages in, (\d+) pages out, .* (\d+) of \d+ slots in use$/
+  or fail "Malformed swap statistics: $swap\n";
+fail "No pages were swapped out.\n" if $out == 0;
+fail "No pages were swapped back in.\n" if $in == 0;
+fail "$used swap slots are still in use after the test exited.\n"
+  if $used != 0;
+pass;
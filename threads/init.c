@@ -18,6 +18,7 @@
 #include "threads/io.h"
 #include "threads/loader.h"
 #include "threads/malloc.h"
+#include "threads/slab.h"
 #include "threads/mmu.h"
 #include "threads/palloc.h"
 #include "threads/pte.h"
@@ -59,6 +60,7 @@ static char **read_command_line(void);
 static char **parse_options(char **argv);
 static void run_actions(char **argv);
 static void usage(void);
+static void set_option(char *option);
 
 static void print_stats(void);
 
@@ -85,7 +87,9 @@ int main(void)
 	/* Initialize memory system. */
 	mem_end = palloc_init();
 	malloc_init();
+	slab_init();
 	paging_init(mem_end);
+	pcid_init();
 
 #ifdef USERPROG
 	tss_init();
@@ -103,6 +107,7 @@ int main(void)
 #endif
 	/* Start thread scheduler and enable interrupts. */
 	thread_start();
+	palloc_start_zeroer();
 	serial_init_queue();
 	timer_calibrate();
 
@@ -143,7 +148,10 @@ bss_init(void)
 
 /* Populates the page table with the kernel virtual mapping,
  * and then sets up the CPU to use the new page directory.
- * Points base_pml4 to the pml4 it creates. */
+ * Points base_pml4 to the pml4 it creates.
+ * Each 2 MB of physical memory that is all writable or all kernel
+ * text is mapped with one 2 MB page, which saves a page table and
+ * 511 TLB entries; the rest is mapped with 4 kB pages. */
 static void
 paging_init(uint64_t mem_end)
 {
@@ -152,18 +160,34 @@ paging_init(uint64_t mem_end)
 	pml4 = base_pml4 = palloc_get_page(PAL_ASSERT | PAL_ZERO);
 
 	extern char start, _end_kernel_text;
+	uint64_t text_start = (uint64_t)&start;
+	uint64_t text_end = (uint64_t)&_end_kernel_text;
 	// Maps physical address [0 ~ mem_end] to
 	//   [LOADER_KERN_BASE ~ LOADER_KERN_BASE + mem_end].
-	for (uint64_t pa = 0; pa < mem_end; pa += PGSIZE)
+	for (uint64_t pa = 0; pa < mem_end;)
 	{
 		uint64_t va = (uint64_t)ptov(pa);
+		uint64_t huge_end = va + HUGE_PGSIZE;
+		bool all_text = text_start <= va && huge_end <= text_end;
+		bool no_text = huge_end <= text_start || text_end <= va;
+
+		if ((pa & HUGE_PGMASK) == 0 && pa + HUGE_PGSIZE <= mem_end
+			&& (all_text || no_text))
+		{
+			perm = PTE_P | PTE_PS | (all_text ? 0 : PTE_W);
+			if ((pte = pml4e_walk_huge(pml4, va, 1)) != NULL)
+				*pte = pa | perm;
+			pa += HUGE_PGSIZE;
+			continue;
+		}
 
 		perm = PTE_P | PTE_W;
-		if ((uint64_t)&start <= va && va < (uint64_t)&_end_kernel_text)
+		if (text_start <= va && va < text_end)
 			perm &= ~PTE_W;
 
 		if ((pte = pml4e_walk(pml4, va, 1)) != NULL)
 			*pte = pa | perm;
+		pa += PGSIZE;
 	}
 
 	// reload cr3
@@ -228,6 +252,14 @@ parse_options(char **argv)
 			random_init(atoi(value));
 		else if (!strcmp(name, "-mlfqs"))
 			thread_mlfqs = true;
+		else if (!strcmp(name, "-tickless"))
+			timer_tickless = true;
+		else if (!strcmp(name, "-lockprof"))
+			lock_profiling = true;
+		else if (!strcmp(name, "-nopcid"))
+			pcid_enabled = false;
+		else if (!strcmp(name, "-o"))
+			set_option(*++argv);
 #ifdef USERPROG
 		else if (!strcmp(name, "-ul"))
 			user_page_limit = atoi(value);
@@ -241,6 +273,27 @@ parse_options(char **argv)
 	return argv;
 }
 
+/* Handles `-o KEY=VALUE'. */
+static void
+set_option(char *option)
+{
+	char *save_ptr;
+	char *key, *value;
+
+	if (option == NULL || (key = strtok_r(option, "=", &save_ptr)) == NULL)
+		PANIC("option `-o' requires an argument (use -h for help)");
+	value = strtok_r(NULL, "", &save_ptr);
+#ifdef VM
+	if (!strcmp(key, "evict") && value != NULL)
+	{
+		if (!vm_set_evict_policy(value))
+			PANIC("unknown eviction policy `%s' (use -h for help)", value);
+		return;
+	}
+#endif
+	PANIC("unknown option `-o %s' (use -h for help)", key);
+}
+
 /* Runs the task specified in ARGV[1]. */
 static void
 run_task(char **argv)
@@ -340,6 +393,13 @@ usage(void)
 		   "  -f                 Format file system disk during startup.\n"
 		   "  -rs=SEED           Set random number seed to SEED.\n"
 		   "  -mlfqs             Use multi-level feedback queue scheduler.\n"
+		   "  -tickless          Stop the timer tick while the CPU is idle.\n"
+		   "  -lockprof          Count lock contention, print it at shutdown.\n"
+		   "  -nopcid            Flush the whole TLB on every address space switch.\n"
+		   "  -o KEY=VALUE       Set a subsystem option:\n"
+#ifdef VM
+		   "    evict=POLICY     Page eviction policy, clock (default) or wsclock.\n"
+#endif
 #ifdef USERPROG
 		   "  -ul=COUNT          Limit user memory to COUNT pages.\n"
 #endif
@@ -369,6 +429,10 @@ print_stats(void)
 {
 	timer_print_stats();
 	thread_print_stats();
+	thread_print_latency();
+	lock_print_stats();
+	palloc_print_stats();
+	kmem_print_stats();
 #ifdef FILESYS
 	disk_print_stats();
 #endif
@@ -377,4 +441,7 @@ print_stats(void)
 #ifdef USERPROG
 	exception_print_stats();
 #endif
+#ifdef VM
+	vm_print_stats();
+#endif
 }
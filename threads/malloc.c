@@ -5,8 +5,10 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include "threads/interrupt.h"
 #include "threads/palloc.h"
 #include "threads/synch.h"
+#include "threads/thread.h"
 #include "threads/vaddr.h"
 
 /* A simple implementation of malloc().
@@ -32,7 +34,40 @@
    because they're too big to fit in a single page with a
    descriptor.  We handle those by allocating contiguous pages
    with the page allocator and sticking the allocation size at
-   the beginning of the allocated block's arena header. */
+   the beginning of the allocated block's arena header.
+
+   In front of the descriptors sits a magazine layer, after
+   Bonwick and Adams, "Magazines and Vmem" (USENIX 2001).  A
+   magazine is a small stack of free blocks of one size.  Each
+   CPU has two magazines per descriptor, "loaded" and "previous",
+   and malloc() and free() pop and push them with interrupts off
+   instead of taking a lock.  Pintos runs on one CPU, so the
+   per-CPU magazines live in the descriptor itself.  Only when
+   both are empty (for malloc()) or both are full (for free())
+   does malloc() take the descriptor's lock, to trade a whole
+   magazine with the descriptor's depot of full and empty
+   magazines.
+
+   The depot keeps at most DEPOT_MAX full and DEPOT_MAX empty
+   magazines.  Beyond that, blocks go back to the free list,
+   where a fully free arena still returns to the page allocator.
+   If the page allocator runs dry, malloc() empties the magazines
+   and every depot back into the free lists and tries once more.
+   The page allocator does the same through malloc_reclaim()
+   when the kernel pool runs dry under any other caller. */
+
+/* Blocks per magazine, chosen to make a magazine 256 bytes. */
+#define MAG_ROUNDS 29
+
+/* Full and empty magazines that a depot keeps. */
+#define DEPOT_MAX 8
+
+/* Magazine. */
+struct magazine {
+	struct list_elem elem;      /* Element in a depot list. */
+	size_t rounds;              /* Number of blocks in round[]. */
+	void *round[MAG_ROUNDS];    /* Free blocks, top at round[rounds - 1]. */
+};
 
 /* Descriptor. */
 struct desc {
@@ -40,6 +75,17 @@ struct desc {
 	size_t blocks_per_arena;    /* Number of blocks in an arena. */
 	struct list free_list;      /* List of free blocks. */
 	struct lock lock;           /* Lock. */
+	char name[16];              /* Lock name, e.g. "malloc 16". */
+
+	/* The CPU's magazines, protected by disabling interrupts. */
+	struct magazine *loaded;    /* Magazine in use, or null. */
+	struct magazine *previous;  /* Spare magazine, or null. */
+
+	/* Depot, protected by LOCK. */
+	struct list full_mags;      /* Full magazines. */
+	struct list empty_mags;     /* Empty magazines. */
+	size_t full_cnt;            /* Length of full_mags. */
+	size_t empty_cnt;           /* Length of empty_mags. */
 };
 
 /* Magic number for detecting arena corruption. */
@@ -60,9 +106,21 @@ struct block {
 /* Our set of descriptors. */
 static struct desc descs[10];   /* Descriptors. */
 static size_t desc_cnt;         /* Number of descriptors. */
+static struct desc *mag_desc;   /* Descriptor that magazines come from. */
 
 static struct arena *block_to_arena (struct block *);
 static struct block *arena_to_block (struct arena *, size_t idx);
+static void *desc_alloc (struct desc *);
+static void desc_free (struct desc *, struct block *);
+static void desc_free_locked (struct desc *, struct block *);
+static void *mag_pop (struct desc *);
+static bool mag_push (struct desc *, void *);
+static void *mag_alloc (struct desc *);
+static bool mag_free (struct desc *, void *);
+static void mag_release (struct desc *, struct magazine *);
+static bool depot_put (struct desc *, struct magazine *);
+static bool desc_lock (struct desc *, bool wait);
+static void mag_flush (bool wait);
 
 /* Initializes the malloc() descriptors. */
 void
@@ -75,8 +133,16 @@ malloc_init (void) {
 		d->block_size = block_size;
 		d->blocks_per_arena = (PGSIZE - sizeof (struct arena)) / block_size;
 		list_init (&d->free_list);
-		lock_init (&d->lock);
+		snprintf (d->name, sizeof d->name, "malloc %zu", block_size);
+		lock_init_named (&d->lock, d->name);
+		list_init (&d->full_mags);
+		list_init (&d->empty_mags);
+		d->full_cnt = d->empty_cnt = 0;
+		d->loaded = d->previous = NULL;
+		if (mag_desc == NULL && block_size >= sizeof (struct magazine))
+			mag_desc = d;
 	}
+	ASSERT (mag_desc != NULL);
 }
 
 /* Obtains and returns a new block of at least SIZE bytes.
@@ -84,8 +150,8 @@ malloc_init (void) {
 void *
 malloc (size_t size) {
 	struct desc *d;
-	struct block *b;
 	struct arena *a;
+	void *b;
 
 	/* A null pointer satisfies a request for 0 bytes. */
 	if (size == 0)
@@ -101,8 +167,12 @@ malloc (size_t size) {
 		   Allocate enough pages to hold SIZE plus an arena. */
 		size_t page_cnt = DIV_ROUND_UP (size + sizeof *a, PGSIZE);
 		a = palloc_get_multiple (0, page_cnt);
-		if (a == NULL)
-			return NULL;
+		if (a == NULL) {
+			mag_flush (true);
+			a = palloc_get_multiple (0, page_cnt);
+			if (a == NULL)
+				return NULL;
+		}
 
 		/* Initialize the arena to indicate a big block of PAGE_CNT
 		   pages, and return it. */
@@ -112,6 +182,24 @@ malloc (size_t size) {
 		return a + 1;
 	}
 
+	b = mag_alloc (d);
+	if (b == NULL)
+		b = desc_alloc (d);
+	if (b == NULL) {
+		mag_flush (true);
+		b = desc_alloc (d);
+	}
+	return b;
+}
+
+/* Takes a block from D's free list, creating a new arena if it
+   is empty.  Returns a null pointer if memory is not
+   available. */
+static void *
+desc_alloc (struct desc *d) {
+	struct block *b;
+	struct arena *a;
+
 	lock_acquire (&d->lock);
 
 	/* If the free list is empty, create a new arena. */
@@ -213,24 +301,8 @@ free (void *p) {
 			memset (b, 0xcc, d->block_size);
 #endif
 
-			lock_acquire (&d->lock);
-
-			/* Add block to free list. */
-			list_push_front (&d->free_list, &b->free_elem);
-
-			/* If the arena is now entirely unused, free it. */
-			if (++a->free_cnt >= d->blocks_per_arena) {
-				size_t i;
-
-				ASSERT (a->free_cnt == d->blocks_per_arena);
-				for (i = 0; i < d->blocks_per_arena; i++) {
-					struct block *b = arena_to_block (a, i);
-					list_remove (&b->free_elem);
-				}
-				palloc_free_page (a);
-			}
-
-			lock_release (&d->lock);
+			if (!mag_free (d, b))
+				desc_free (d, b);
 		} else {
 			/* It's a big block.  Free its pages. */
 			palloc_free_multiple (a, a->free_cnt);
@@ -239,6 +311,277 @@ free (void *p) {
 	}
 }
 
+/* Returns block B to D's free list. */
+static void
+desc_free (struct desc *d, struct block *b) {
+	lock_acquire (&d->lock);
+	desc_free_locked (d, b);
+	lock_release (&d->lock);
+}
+
+/* Returns block B to D's free list, freeing its arena if that
+   leaves the arena unused.  D's lock must be held. */
+static void
+desc_free_locked (struct desc *d, struct block *b) {
+	struct arena *a = block_to_arena (b);
+
+	ASSERT (lock_held_by_current_thread (&d->lock));
+
+	/* Add block to free list. */
+	list_push_front (&d->free_list, &b->free_elem);
+
+	/* If the arena is now entirely unused, free it. */
+	if (++a->free_cnt >= d->blocks_per_arena) {
+		size_t i;
+
+		ASSERT (a->free_cnt == d->blocks_per_arena);
+		for (i = 0; i < d->blocks_per_arena; i++) {
+			struct block *b = arena_to_block (a, i);
+			list_remove (&b->free_elem);
+		}
+		palloc_free_page (a);
+	}
+}
+
+/* Pops a block off D's magazines, swapping them if the loaded
+   one is empty.  Returns a null pointer if both are empty.
+   Interrupts must be off. */
+static void *
+mag_pop (struct desc *d) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (d->loaded == NULL || d->loaded->rounds == 0) {
+		struct magazine *m = d->loaded;
+
+		if (d->previous == NULL || d->previous->rounds == 0)
+			return NULL;
+		d->loaded = d->previous;
+		d->previous = m;
+	}
+	return d->loaded->round[--d->loaded->rounds];
+}
+
+/* Pushes block B onto D's magazines, swapping them if the loaded
+   one is full.  Returns false if both are full or missing.
+   Interrupts must be off. */
+static bool
+mag_push (struct desc *d, void *b) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (d->loaded == NULL || d->loaded->rounds == MAG_ROUNDS) {
+		struct magazine *m = d->loaded;
+
+		if (d->previous == NULL || d->previous->rounds == MAG_ROUNDS)
+			return false;
+		d->loaded = d->previous;
+		d->previous = m;
+	}
+	d->loaded->round[d->loaded->rounds++] = b;
+	return true;
+}
+
+/* Pops a block of D's size off the CPU's magazines, refilling
+   them from D's depot if both are empty.  Returns a null pointer
+   if the depot has no full magazine either. */
+static void *
+mag_alloc (struct desc *d) {
+	struct magazine *full, *spare;
+	enum intr_level old_level;
+	void *b;
+
+	ASSERT (!intr_context ());
+
+	old_level = intr_disable ();
+	b = mag_pop (d);
+	intr_set_level (old_level);
+	if (b != NULL)
+		return b;
+
+	/* Both are empty: trade one for a full one. */
+	lock_acquire (&d->lock);
+	if (list_empty (&d->full_mags)) {
+		lock_release (&d->lock);
+		return NULL;
+	}
+	full = list_entry (list_pop_front (&d->full_mags), struct magazine, elem);
+	d->full_cnt--;
+	lock_release (&d->lock);
+
+	/* Other threads may have used the magazines meanwhile, so
+	   whatever is displaced goes back through the depot. */
+	old_level = intr_disable ();
+	b = full->round[--full->rounds];
+	spare = d->previous;
+	d->previous = d->loaded;
+	d->loaded = full;
+	intr_set_level (old_level);
+
+	if (spare != NULL)
+		mag_release (d, spare);
+	return b;
+}
+
+/* Pushes block B of D's size onto the CPU's magazines, trading a
+   full magazine for an empty one from D's depot if both are full.
+   Returns false if no empty magazine could be found or allocated,
+   in which case the caller must free B itself. */
+static bool
+mag_free (struct desc *d, void *b) {
+	struct magazine *empty = NULL, *spare;
+	enum intr_level old_level;
+	bool pushed;
+
+	ASSERT (!intr_context ());
+
+	old_level = intr_disable ();
+	pushed = mag_push (d, b);
+	intr_set_level (old_level);
+	if (pushed)
+		return true;
+
+	/* Both are full or missing: trade one for an empty one. */
+	lock_acquire (&d->lock);
+	if (!list_empty (&d->empty_mags)) {
+		empty = list_entry (list_pop_front (&d->empty_mags),
+				struct magazine, elem);
+		d->empty_cnt--;
+	}
+	lock_release (&d->lock);
+
+	/* Magazines come from the descriptor layer directly, so that
+	   this cannot recurse into the magazine layer. */
+	if (empty == NULL) {
+		empty = desc_alloc (mag_desc);
+		if (empty == NULL)
+			return false;
+	}
+	empty->round[0] = b;
+	empty->rounds = 1;
+
+	old_level = intr_disable ();
+	spare = d->previous;
+	d->previous = d->loaded;
+	d->loaded = empty;
+	intr_set_level (old_level);
+
+	if (spare != NULL)
+		mag_release (d, spare);
+	return true;
+}
+
+/* Gives magazine M, which the CPU no longer uses, to D's depot,
+   or frees it if the depot has no room. */
+static void
+mag_release (struct desc *d, struct magazine *m) {
+	bool kept;
+
+	lock_acquire (&d->lock);
+	kept = depot_put (d, m);
+	lock_release (&d->lock);
+
+	if (!kept)
+		desc_free (mag_desc, (struct block *) m);
+}
+
+/* Puts magazine M in D's depot: with the full magazines if it is
+   full and there is room, otherwise with the empty ones once its
+   blocks are back on the free list.  Returns false if there is no
+   room for it as an empty magazine either, in which case the
+   caller must free M after releasing D's lock.  D's lock must be
+   held. */
+static bool
+depot_put (struct desc *d, struct magazine *m) {
+	ASSERT (lock_held_by_current_thread (&d->lock));
+
+	if (m->rounds == MAG_ROUNDS && d->full_cnt < DEPOT_MAX) {
+		list_push_front (&d->full_mags, &m->elem);
+		d->full_cnt++;
+		return true;
+	}
+	while (m->rounds > 0)
+		desc_free_locked (d, m->round[--m->rounds]);
+	if (d->empty_cnt < DEPOT_MAX) {
+		list_push_front (&d->empty_mags, &m->elem);
+		d->empty_cnt++;
+		return true;
+	}
+	return false;
+}
+
+/* Acquires D's lock.  If WAIT is false, only tries to, and fails
+   if the lock is busy or already held by the current thread. */
+static bool
+desc_lock (struct desc *d, bool wait) {
+	if (wait) {
+		lock_acquire (&d->lock);
+		return true;
+	}
+	return !lock_held_by_current_thread (&d->lock)
+		&& lock_try_acquire (&d->lock);
+}
+
+/* Empties the CPU's magazines and every depot into the
+   descriptors' free lists, so that arenas left entirely free go
+   back to the page allocator, and frees the magazines
+   themselves.  Called when the page allocator runs dry.  If WAIT
+   is false, skips descriptors whose lock is busy, so that it is
+   safe to call from inside the allocator. */
+static void
+mag_flush (bool wait) {
+	size_t i;
+
+	/* Freed magazines go to mag_desc, so hold its lock throughout. */
+	if (!desc_lock (mag_desc, wait))
+		return;
+
+	for (i = 0; i < desc_cnt; i++) {
+		struct desc *d = &descs[i];
+		struct list spare;
+		struct list_elem *e;
+		enum intr_level old_level;
+
+		if (d != mag_desc && !desc_lock (d, wait))
+			continue;
+
+		list_init (&spare);
+		old_level = intr_disable ();
+		if (d->loaded != NULL)
+			list_push_back (&spare, &d->loaded->elem);
+		if (d->previous != NULL)
+			list_push_back (&spare, &d->previous->elem);
+		d->loaded = d->previous = NULL;
+		intr_set_level (old_level);
+
+		while (!list_empty (&d->full_mags))
+			list_push_back (&spare, list_pop_front (&d->full_mags));
+		while (!list_empty (&d->empty_mags))
+			list_push_back (&spare, list_pop_front (&d->empty_mags));
+		d->full_cnt = d->empty_cnt = 0;
+		for (e = list_begin (&spare); e != list_end (&spare); e = list_next (e)) {
+			struct magazine *m = list_entry (e, struct magazine, elem);
+			while (m->rounds > 0)
+				desc_free_locked (d, m->round[--m->rounds]);
+		}
+		if (d != mag_desc)
+			lock_release (&d->lock);
+
+		while (!list_empty (&spare))
+			desc_free_locked (mag_desc, (struct block *) list_entry (
+					list_pop_front (&spare), struct magazine, elem));
+	}
+	lock_release (&mag_desc->lock);
+}
+
+/* Returns the free blocks cached in magazines to the page
+   allocator, as far as that can be done without waiting for a
+   lock.  Called by the page allocator when the kernel pool runs
+   dry. */
+void
+malloc_reclaim (void) {
+	if (mag_desc != NULL && !intr_context ())
+		mag_flush (false);
+}
+
 /* Returns the arena that block B is inside. */
 static struct arena *
 block_to_arena (struct block *b) {
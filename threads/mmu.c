@@ -2,12 +2,124 @@
 #include <stddef.h>
 #include <string.h>
 #include "threads/init.h"
+#include "threads/interrupt.h"
 #include "threads/pte.h"
 #include "threads/palloc.h"
 #include "threads/thread.h"
 #include "threads/mmu.h"
 #include "intrinsic.h"
 
+/* Process-context identifiers.
+
+   Without PCIDs, every CR3 load flushes the TLB, so a process
+   that has just been switched back in refaults every page it
+   touches into the TLB.  With CR4.PCIDE set, TLB entries are
+   tagged with the PCID in the low 12 bits of CR3, and a CR3 load
+   with CR3_NOFLUSH set keeps the entries of the PCID it loads.
+
+   PCID 0 is base_pml4's, and any pml4's while PCIDs are disabled.
+   Other pml4s hash by address onto the rest.  pcid_owner[] says
+   which pml4 the TLB entries of each PCID belong to.  A pml4 that
+   finds its PCID owned by another takes it over and flushes the
+   old entries.  Whenever a pml4 changes in a way that its stale
+   TLB entries could be used, it gives its PCID up, so the next
+   load of it flushes. */
+#define PCID_CNT 4096
+#define CR3_NOFLUSH (1ULL << 63)
+#define CR4_PCIDE (1 << 17)
+#define CPUID_1_ECX_PCID (1 << 17)
+
+bool pcid_supported;
+bool pcid_enabled = true;
+static uint64_t *pcid_owner[PCID_CNT];
+
+/* Turns on PCIDs if the CPU has them and -nopcid was not given.
+   Must be called with a CR3 whose PCID is 0. */
+void
+pcid_init (void) {
+	uint32_t eax, ebx, ecx, edx;
+
+	cpuid (1, 0, &eax, &ebx, &ecx, &edx);
+	if (!pcid_enabled || !(ecx & CPUID_1_ECX_PCID)) {
+		pcid_enabled = false;
+		return;
+	}
+	lcr4 (rcr4 () | CR4_PCIDE);
+	pcid_supported = true;
+	pcid_owner[0] = PTE_ADDR (rcr3 ()) == vtop (base_pml4) ? base_pml4 : NULL;
+}
+
+/* Turns the use of PCIDs on or off at run time, if the CPU has
+   them.  Every PCID's entries are treated as stale afterwards,
+   since they may have been left behind under the other mode. */
+void
+pcid_enable (bool enable) {
+	enum intr_level old_level;
+
+	if (!pcid_supported)
+		return;
+	old_level = intr_disable ();
+	pcid_enabled = enable;
+	memset (pcid_owner, 0, sizeof pcid_owner);
+	intr_set_level (old_level);
+}
+
+/* Returns the PCID that PML4 uses when PCIDs are enabled. */
+static unsigned
+pcid_of (uint64_t *pml4) {
+	if (pml4 == base_pml4)
+		return 0;
+	return 1 + pg_no (vtop (pml4)) % (PCID_CNT - 1);
+}
+
+/* Makes PML4 give up its PCID, so that the next time it is loaded
+   the TLB entries tagged with the PCID are flushed. */
+static void
+pcid_forget (uint64_t *pml4) {
+	unsigned pcid = pcid_of (pml4);
+
+	if (pcid_owner[pcid] == pml4)
+		pcid_owner[pcid] = NULL;
+	if (pcid_owner[0] == pml4)
+		pcid_owner[0] = NULL;
+}
+
+/* Removes the TLB entry for VA in PML4, which was just changed. */
+static void
+tlb_invalidate (uint64_t *pml4, const void *va) {
+	if (PTE_ADDR (rcr3 ()) == vtop (pml4))
+		invlpg ((uint64_t) va);
+	else
+		pcid_forget (pml4);
+}
+
+/* Replaces the 2 MB mapping at VA in PML4, whose page directory
+ * entry is PDE, by a page table that maps the same memory, with
+ * the same permissions, as 512 4 kB pages.  The translation stays
+ * the same, but the page size changes, which the SDM requires to
+ * be followed by invalidating the whole range.  Returns false if
+ * out of memory. */
+static bool
+split_huge (uint64_t *pml4, uint64_t *pde, uint64_t va) {
+	uint64_t pa = PTE_ADDR (*pde) & ~HUGE_PGMASK;
+	uint64_t flags = *pde & PTE_FLAGS & ~(uint64_t) PTE_PS;
+	uint64_t *pt = palloc_get_page (0);
+
+	if (pt == NULL)
+		return false;
+	for (unsigned i = 0; i < HUGE_PGCNT; i++)
+		pt[i] = (pa + i * PGSIZE) | flags;
+	*pde = vtop (pt) | PTE_U | PTE_W | PTE_P;
+
+	va &= ~(uint64_t) HUGE_PGMASK;
+	if (PTE_ADDR (rcr3 ()) == vtop (pml4))
+		for (unsigned i = 0; i < HUGE_PGCNT; i++)
+			invlpg (va + i * PGSIZE);
+	else
+		pcid_forget (pml4);
+	return true;
+}
+
 static uint64_t *
 pgdir_walk (uint64_t *pdp, const uint64_t va, int create) {
 	int idx = PDX (va);
@@ -22,6 +134,10 @@ pgdir_walk (uint64_t *pdp, const uint64_t va, int create) {
 					return NULL;
 			} else
 				return NULL;
+		} else if ((uint64_t) pte & PTE_PS) {
+			/* VA is in a 2 MB page, which has no 4 kB PTE.
+			   pml4e_walk() splits it first if CREATE. */
+			return NULL;
 		}
 		return (uint64_t *) ptov (PTE_ADDR (pdp[idx]) + 8 * PTX (va));
 	}
@@ -60,12 +176,23 @@ pdpe_walk (uint64_t *pdpe, const uint64_t va, int create) {
  * If PML4E does not have a page table for VADDR, behavior depends
  * on CREATE.  If CREATE is true, then a new page table is
  * created and a pointer into it is returned.  Otherwise, a null
- * pointer is returned. */
+ * pointer is returned.
+ * If VADDR is in a 2 MB page, a caller with CREATE set is about to
+ * modify the PTE, so the 2 MB page is split into 4 kB pages first.
+ * Without CREATE, a null pointer is returned; use pte_lookup() to
+ * look at a 2 MB mapping without splitting it. */
 uint64_t *
 pml4e_walk (uint64_t *pml4e, const uint64_t va, int create) {
 	uint64_t *pte = NULL;
 	int idx = PML4 (va);
 	int allocated = 0;
+	if (pml4e && create) {
+		uint64_t *pde = pml4e_walk_huge (pml4e, va, 0);
+
+		if (pde != NULL && (*pde & (PTE_P | PTE_PS)) == (PTE_P | PTE_PS)
+				&& !split_huge (pml4e, pde, va))
+			return NULL;
+	}
 	if (pml4e) {
 		uint64_t *pdpe = (uint64_t *) pml4e[idx];
 		if (!((uint64_t) pdpe & PTE_P)) {
@@ -88,6 +215,57 @@ pml4e_walk (uint64_t *pml4e, const uint64_t va, int create) {
 	return pte;
 }
 
+/* Returns the address of the page directory entry for virtual
+ * address VA in page map level 4 PML4.  The entry may be empty,
+ * point to a page table, or map a 2 MB page (PTE_PS).
+ * If the page directory for VA does not exist, behavior depends
+ * on CREATE: if CREATE is true, it is created, otherwise a null
+ * pointer is returned.  Also returns a null pointer if memory
+ * allocation fails. */
+uint64_t *
+pml4e_walk_huge (uint64_t *pml4, const uint64_t va, int create) {
+	uint64_t *pdp, *pd;
+	bool allocated = false;
+
+	if (pml4 == NULL)
+		return NULL;
+	if (!(pml4[PML4 (va)] & PTE_P)) {
+		if (!create || (pdp = palloc_get_page (PAL_ZERO)) == NULL)
+			return NULL;
+		pml4[PML4 (va)] = vtop (pdp) | PTE_U | PTE_W | PTE_P;
+		allocated = true;
+	}
+	pdp = ptov (PTE_ADDR (pml4[PML4 (va)]));
+	if (!(pdp[PDPE (va)] & PTE_P)) {
+		if (!create || (pd = palloc_get_page (PAL_ZERO)) == NULL) {
+			if (allocated) {
+				palloc_free_page (pdp);
+				pml4[PML4 (va)] = 0;
+			}
+			return NULL;
+		}
+		pdp[PDPE (va)] = vtop (pd) | PTE_U | PTE_W | PTE_P;
+	}
+	pd = ptov (PTE_ADDR (pdp[PDPE (va)]));
+	return &pd[PDX (va)];
+}
+
+/* Returns the entry that maps VA in PML4 without creating or
+ * splitting anything: a PTE, or a page directory entry if VA is in
+ * a 2 MB page, in which case *HUGE is set to true.  Returns a null
+ * pointer if VA's page table does not exist. */
+static uint64_t *
+pte_lookup (uint64_t *pml4, const void *va, bool *huge) {
+	uint64_t *pde = pml4e_walk_huge (pml4, (uint64_t) va, 0);
+
+	if (pde == NULL || !(*pde & PTE_P))
+		return NULL;
+	*huge = (*pde & PTE_PS) != 0;
+	if (*huge)
+		return pde;
+	return (uint64_t *) ptov (PTE_ADDR (*pde)) + PTX (va);
+}
+
 /* Creates a new page map level 4 (pml4) has mappings for kernel
  * virtual addresses, but none for user virtual addresses.
  * Returns the new page directory, or a null pointer if memory
@@ -122,10 +300,17 @@ pgdir_for_each (uint64_t *pdp, pte_for_each_func *func, void *aux,
 		unsigned pml4_index, unsigned pdp_index) {
 	for (unsigned i = 0; i < PGSIZE / sizeof(uint64_t *); i++) {
 		uint64_t *pte = ptov((uint64_t *) pdp[i]);
-		if (((uint64_t) pte) & PTE_P)
-			if (!pt_for_each ((uint64_t *) PTE_ADDR (pte), func, aux,
-					pml4_index, pdp_index, i))
+		if (!(((uint64_t) pte) & PTE_P))
+			continue;
+		if (pdp[i] & PTE_PS) {
+			void *va = (void *) (((uint64_t) pml4_index << PML4SHIFT) |
+								 ((uint64_t) pdp_index << PDPESHIFT) |
+								 ((uint64_t) i << PDXSHIFT));
+			if (!func (&pdp[i], va, aux))
 				return false;
+		} else if (!pt_for_each ((uint64_t *) PTE_ADDR (pte), func, aux,
+					pml4_index, pdp_index, i))
+			return false;
 	}
 	return true;
 }
@@ -143,7 +328,9 @@ pdp_for_each (uint64_t *pdp,
 	return true;
 }
 
-/* Apply FUNC to each available pte entries including kernel's. */
+/* Apply FUNC to each available pte entries including kernel's.
+ * A 2 MB page is passed once, as its page directory entry, which
+ * has PTE_PS set. */
 bool
 pml4_for_each (uint64_t *pml4, pte_for_each_func *func, void *aux) {
 	for (unsigned i = 0; i < PGSIZE / sizeof(uint64_t *); i++) {
@@ -169,7 +356,12 @@ static void
 pgdir_destroy (uint64_t *pdp) {
 	for (unsigned i = 0; i < PGSIZE / sizeof(uint64_t *); i++) {
 		uint64_t *pte = ptov((uint64_t *) pdp[i]);
-		if (((uint64_t) pte) & PTE_P)
+		if (!(((uint64_t) pte) & PTE_P))
+			continue;
+		if (pdp[i] & PTE_PS)
+			palloc_free_multiple ((void *) (PTE_ADDR (pte) & ~HUGE_PGMASK),
+					HUGE_PGCNT);
+		else
 			pt_destroy (PTE_ADDR (pte));
 	}
 	palloc_free_page ((void *) pdp);
@@ -196,14 +388,33 @@ pml4_destroy (uint64_t *pml4) {
 	uint64_t *pdpe = ptov ((uint64_t *) pml4[0]);
 	if (((uint64_t) pdpe) & PTE_P)
 		pdpe_destroy ((void *) PTE_ADDR (pdpe));
+	pcid_forget (pml4);
 	palloc_free_page ((void *) pml4);
 }
 
 /* Loads page directory PD into the CPU's page directory base
- * register. */
+ * register.  With PCIDs, the TLB entries PD left behind the last
+ * time it was loaded are kept, if they are still valid. */
 void
 pml4_activate (uint64_t *pml4) {
-	lcr3 (vtop (pml4 ? pml4 : base_pml4));
+	uint64_t cr3;
+
+	if (pml4 == NULL)
+		pml4 = base_pml4;
+	cr3 = vtop (pml4);
+	if (pcid_supported) {
+		unsigned pcid = pcid_enabled ? pcid_of (pml4) : 0;
+
+		cr3 |= pcid;
+		if (pcid_owner[pcid] == pml4) {
+			/* Switching to ourselves: nothing to do. */
+			if (rcr3 () == cr3)
+				return;
+			cr3 |= CR3_NOFLUSH;
+		} else
+			pcid_owner[pcid] = pml4;
+	}
+	lcr3 (cr3);
 }
 
 /* Looks up the physical address that corresponds to user virtual
@@ -214,8 +425,12 @@ void *
 pml4_get_page (uint64_t *pml4, const void *uaddr) {
 	ASSERT (is_user_vaddr (uaddr));
 
-	uint64_t *pte = pml4e_walk (pml4, (uint64_t) uaddr, 0);
+	bool huge;
+	uint64_t *pte = pte_lookup (pml4, uaddr, &huge);
 
+	if (pte && huge)
+		return ptov (PTE_ADDR (*pte) & ~HUGE_PGMASK)
+			+ ((uint64_t) uaddr & HUGE_PGMASK);
 	if (pte && (*pte & PTE_P))
 		return ptov (PTE_ADDR (*pte)) + pg_ofs (uaddr);
 	return NULL;
@@ -238,11 +453,39 @@ pml4_set_page (uint64_t *pml4, void *upage, void *kpage, bool rw) {
 
 	uint64_t *pte = pml4e_walk (pml4, (uint64_t) upage, 1);
 
-	if (pte)
+	if (pte) {
+		bool was_present = (*pte & PTE_P) != 0;
+
 		*pte = vtop (kpage) | PTE_P | (rw ? PTE_W : 0) | PTE_U;
+		if (was_present)
+			tlb_invalidate (pml4, upage);
+	}
 	return pte != NULL;
 }
 
+/* Adds a mapping in PML4 from the 2 MB of user virtual memory at
+ * UPAGE to the 2 MB of physical memory at kernel virtual address
+ * KPAGE, which should come from palloc_get_huge_page().  Both
+ * must be 2 MB aligned, and nothing in the range may be mapped
+ * yet.  Later calls that change a 4 kB page inside the range split
+ * the mapping into 512 small pages.
+ * Returns true if successful, false if the range is already
+ * (partly) mapped or memory allocation failed. */
+bool
+pml4_set_huge_page (uint64_t *pml4, void *upage, void *kpage, bool rw) {
+	ASSERT (((uint64_t) upage & HUGE_PGMASK) == 0);
+	ASSERT ((vtop (kpage) & HUGE_PGMASK) == 0);
+	ASSERT (is_user_vaddr (upage));
+	ASSERT (pml4 != base_pml4);
+
+	uint64_t *pde = pml4e_walk_huge (pml4, (uint64_t) upage, 1);
+
+	if (pde == NULL || (*pde & PTE_P))
+		return false;
+	*pde = vtop (kpage) | PTE_PS | PTE_P | (rw ? PTE_W : 0) | PTE_U;
+	return true;
+}
+
 /* Marks user virtual page UPAGE "not present" in page
  * directory PD.  Later accesses to the page will fault.  Other
  * bits in the page table entry are preserved.
@@ -250,25 +493,32 @@ pml4_set_page (uint64_t *pml4, void *upage, void *kpage, bool rw) {
 void
 pml4_clear_page (uint64_t *pml4, void *upage) {
 	uint64_t *pte;
+	bool huge;
+
 	ASSERT (pg_ofs (upage) == 0);
 	ASSERT (is_user_vaddr (upage));
 
-	pte = pml4e_walk (pml4, (uint64_t) upage, false);
+	/* Clearing one 4 kB page of a 2 MB page needs a split. */
+	pte = pte_lookup (pml4, upage, &huge);
+	if (pte != NULL && huge)
+		pte = pml4e_walk (pml4, (uint64_t) upage, true);
+	else
+		pte = pml4e_walk (pml4, (uint64_t) upage, false);
 
 	if (pte != NULL && (*pte & PTE_P) != 0) {
 		*pte &= ~PTE_P;
-		if (rcr3 () == vtop (pml4))
-			invlpg ((uint64_t) upage);
+		tlb_invalidate (pml4, upage);
 	}
 }
 
 /* Returns true if the PTE for virtual page VPAGE in PML4 is dirty,
  * that is, if the page has been modified since the PTE was
- * installed.
+ * installed.  For a 2 MB page, this covers the whole 2 MB.
  * Returns false if PML4 contains no PTE for VPAGE. */
 bool
 pml4_is_dirty (uint64_t *pml4, const void *vpage) {
-	uint64_t *pte = pml4e_walk (pml4, (uint64_t) vpage, false);
+	bool huge;
+	uint64_t *pte = pte_lookup (pml4, vpage, &huge);
 	return pte != NULL && (*pte & PTE_D) != 0;
 }
 
@@ -276,15 +526,15 @@ pml4_is_dirty (uint64_t *pml4, const void *vpage) {
  * in PML4. */
 void
 pml4_set_dirty (uint64_t *pml4, const void *vpage, bool dirty) {
-	uint64_t *pte = pml4e_walk (pml4, (uint64_t) vpage, false);
+	bool huge;
+	uint64_t *pte = pte_lookup (pml4, vpage, &huge);
 	if (pte) {
 		if (dirty)
 			*pte |= PTE_D;
 		else
 			*pte &= ~(uint32_t) PTE_D;
 
-		if (rcr3 () == vtop (pml4))
-			invlpg ((uint64_t) vpage);
+		tlb_invalidate (pml4, vpage);
 	}
 }
 
@@ -294,7 +544,8 @@ pml4_set_dirty (uint64_t *pml4, const void *vpage, bool dirty) {
  * PML4 contains no PTE for VPAGE. */
 bool
 pml4_is_accessed (uint64_t *pml4, const void *vpage) {
-	uint64_t *pte = pml4e_walk (pml4, (uint64_t) vpage, false);
+	bool huge;
+	uint64_t *pte = pte_lookup (pml4, vpage, &huge);
 	return pte != NULL && (*pte & PTE_A) != 0;
 }
 
@@ -302,14 +553,30 @@ pml4_is_accessed (uint64_t *pml4, const void *vpage) {
    VPAGE in PD. */
 void
 pml4_set_accessed (uint64_t *pml4, const void *vpage, bool accessed) {
-	uint64_t *pte = pml4e_walk (pml4, (uint64_t) vpage, false);
+	bool huge;
+	uint64_t *pte = pte_lookup (pml4, vpage, &huge);
 	if (pte) {
 		if (accessed)
 			*pte |= PTE_A;
 		else
 			*pte &= ~(uint32_t) PTE_A;
 
-		if (rcr3 () == vtop (pml4))
-			invlpg ((uint64_t) vpage);
+		tlb_invalidate (pml4, vpage);
+	}
+}
+
+/* Sets the writable bit to WRITABLE in the PTE for virtual page
+ * VPAGE in PML4, keeping the accessed and dirty bits. */
+void
+pml4_set_writable (uint64_t *pml4, const void *vpage, bool writable) {
+	bool huge;
+	uint64_t *pte = pte_lookup (pml4, vpage, &huge);
+	if (pte) {
+		if (writable)
+			*pte |= PTE_W;
+		else
+			*pte &= ~(uint64_t) PTE_W;
+
+		tlb_invalidate (pml4, vpage);
 	}
 }
@@ -2,14 +2,19 @@
 #include <bitmap.h>
 #include <debug.h>
 #include <inttypes.h>
+#include <list.h>
 #include <round.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include "threads/init.h"
+#include "threads/interrupt.h"
 #include "threads/loader.h"
+#include "threads/malloc.h"
+#include "threads/pte.h"
 #include "threads/synch.h"
+#include "threads/thread.h"
 #include "threads/vaddr.h"
 
 /* Page allocator.  Hands out memory in page-size (or
@@ -24,13 +29,76 @@
 
    By default, half of system RAM is given to the kernel pool and
    half to the user pool.  That should be huge overkill for the
-   kernel pool, but that's just fine for demonstration purposes. */
+   kernel pool, but that's just fine for demonstration purposes.
+
+   Within a pool, pages are handed out by a binary buddy
+   allocator.  Free memory is kept as blocks of 2**ORDER pages
+   that start at a page index that is a multiple of 2**ORDER, on
+   one free list per order.  An allocation of N pages takes the
+   smallest free block of at least N pages, splitting larger
+   blocks in half as needed, and gives back the pages past N.
+   Freeing a block merges it with its "buddy", the other half of
+   the block of the next order up, for as long as the buddy is
+   free too.  Both take time logarithmic in the pool size, where
+   the old bitmap scan was linear.
+
+   The list elements and orders live in arrays next to the pool's
+   bitmap rather than in the free pages themselves, so that the
+   allocator never touches memory it does not hand out.  The
+   bitmap of used pages is still kept, as a cross-check on the
+   buddy lists in debug builds.
+
+   Each pool also keeps a small stock of pages that are already
+   zeroed, so that a single-page PAL_ZERO request (a new thread's
+   page, a page table, a zero-filled user page) does not have to
+   clear 4 kB on the caller's path.  The "zeroer" kernel thread
+   runs at the lowest priority, so it only gets the CPU when
+   nothing else wants it, and is left out of the 4.4BSD load
+   average.  Once a stock falls below ZERO_LOW pages, the next
+   allocation wakes it, and it tops the stock back up to
+   ZERO_TARGET pages from the buddy lists, unless fewer than
+   ZERO_FREE_MIN pages are left free in the pool: when memory is
+   short, pages are worth more free than pre-zeroed.  Pages in the stock
+   are allocated as far as the buddy lists are concerned; if an
+   allocation cannot be met otherwise, the stock is given back
+   first.
+
+   A pool is protected by turning interrupts off, not by a lock.
+   Every operation on it is short, and pages are also freed where
+   sleeping is not allowed: schedule() frees a dying thread's page
+   with interrupts already off, and releasing a lock there could
+   switch threads in the middle of a switch. */
+
+/* Number of block orders: the largest block is 2**(ORDER_CNT - 1)
+   pages. */
+#define ORDER_CNT 20
+
+/* free_order[] value of a page that does not start a free block. */
+#define NOT_FREE 0xff
+
+/* Number of pre-zeroed pages the zeroer keeps in each pool. */
+#define ZERO_TARGET 32
+
+/* Stock level below which an allocation wakes the zeroer. */
+#define ZERO_LOW (ZERO_TARGET / 4)
+
+/* Free pages below which the zeroer leaves a pool alone. */
+#define ZERO_FREE_MIN (ZERO_TARGET * 4)
 
 /* A memory pool. */
 struct pool {
-	struct lock lock;               /* Mutual exclusion. */
-	struct bitmap *used_map;        /* Bitmap of free pages. */
+	struct bitmap *used_map;        /* Bitmap of used pages. */
 	uint8_t *base;                  /* Base of pool. */
+	size_t page_cnt;                /* Number of pages in pool. */
+	struct list free_lists[ORDER_CNT];  /* Free blocks, by order. */
+	struct list_elem *free_elems;   /* Per page: elem in free_lists. */
+	uint8_t *free_order;            /* Per page: order of the free block
+	                                   it starts, or NOT_FREE. */
+	size_t free_cnt;                /* Pages in free_lists. */
+	struct list zeroed;             /* Pre-zeroed pages, by free_elems. */
+	size_t zeroed_cnt;              /* Number of pages in zeroed. */
+	unsigned long long zero_hits;   /* PAL_ZERO pages taken from zeroed. */
+	unsigned long long zero_misses; /* PAL_ZERO pages zeroed inline. */
 };
 
 /* Two pools: one for kernel data, one for user pages. */
@@ -42,6 +110,23 @@ static void
 init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end);
 
 static bool page_from_pool (const struct pool *, void *page);
+static void init_free_lists (struct pool *);
+static size_t pool_alloc (struct pool *, size_t page_cnt, bool zero_miss);
+static size_t buddy_alloc (struct pool *, size_t page_cnt);
+static void buddy_free (struct pool *, size_t page_idx, size_t page_cnt);
+static void buddy_free_block (struct pool *, size_t page_idx, int order);
+static void *zeroed_take (struct pool *);
+static void zeroed_drain (struct pool *);
+static bool zeroed_refill (struct pool *);
+static void zeroer (void *aux);
+static void zeroer_wake (void);
+
+/* Ups to wake the zeroer when a pool's stock runs low. */
+static struct semaphore zero_wake;
+
+/* True while the zeroer sleeps on zero_wake.  Whoever wakes it
+   clears this, so that it is upped only once per sleep. */
+static bool zeroer_asleep;
 
 /* multiboot info */
 struct multiboot_info {
@@ -250,9 +335,19 @@ palloc_init (void) {
 	printf ("\text_mem: 0x%llx ~ 0x%llx (Usable: %'llu kB)\n",
 		  ext_mem.start, ext_mem.end, ext_mem.size / 1024);
 	populate_pools (&base_mem, &ext_mem);
+	init_free_lists (&kernel_pool);
+	init_free_lists (&user_pool);
+	sema_init (&zero_wake, 0);
 	return ext_mem.end;
 }
 
+/* Starts the thread that keeps the pools' stocks of pre-zeroed
+   pages filled.  Must be called after thread_start(). */
+void
+palloc_start_zeroer (void) {
+	thread_create ("zeroer", PRI_MIN, zeroer, NULL);
+}
+
 /* Obtains and returns a group of PAGE_CNT contiguous free pages.
    If PAL_USER is set, the pages are obtained from the user pool,
    otherwise from the kernel pool.  If PAL_ZERO is set in FLAGS,
@@ -262,10 +357,22 @@ palloc_init (void) {
 void *
 palloc_get_multiple (enum palloc_flags flags, size_t page_cnt) {
 	struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
+	bool zero_miss = false;
 
-	lock_acquire (&pool->lock);
-	size_t page_idx = bitmap_scan_and_flip (pool->used_map, 0, page_cnt, false);
-	lock_release (&pool->lock);
+	if ((flags & PAL_ZERO) && page_cnt == 1) {
+		void *page = zeroed_take (pool);
+		if (page != NULL)
+			return page;
+		zero_miss = true;
+	}
+
+	size_t page_idx = pool_alloc (pool, page_cnt, zero_miss);
+	if (page_idx == BITMAP_ERROR && pool == &kernel_pool) {
+		/* Free blocks cached by malloc() may be pinning whole
+		   arenas. */
+		malloc_reclaim ();
+		page_idx = pool_alloc (pool, page_cnt, false);
+	}
 	void *pages;
 
 	if (page_idx != BITMAP_ERROR)
@@ -284,6 +391,54 @@ palloc_get_multiple (enum palloc_flags flags, size_t page_cnt) {
 	return pages;
 }
 
+/* Obtains a 2 MB "huge" page: HUGE_PGCNT contiguous free pages
+   whose physical address is 2 MB aligned, so that they can be
+   mapped with a single page directory entry.  FLAGS are as for
+   palloc_get_multiple().  The pages may be freed all at once with
+   palloc_free_multiple() or one at a time.  Returns a null
+   pointer if no aligned run is free; callers should then fall
+   back to small pages. */
+void *
+palloc_get_huge_page (enum palloc_flags flags) {
+	struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
+	size_t base_pg = pg_no (vtop (pool->base));
+	size_t page_idx, huge_idx;
+	void *pages = NULL;
+	enum intr_level old_level;
+
+	old_level = intr_disable ();
+	if (base_pg % HUGE_PGCNT == 0) {
+		/* Buddy blocks of HUGE_PGCNT pages are aligned already. */
+		page_idx = buddy_alloc (pool, HUGE_PGCNT);
+		huge_idx = page_idx;
+	} else {
+		/* Take twice as much and give back the unaligned ends. */
+		page_idx = buddy_alloc (pool, 2 * HUGE_PGCNT);
+		huge_idx = page_idx + (HUGE_PGCNT
+				- (base_pg + page_idx) % HUGE_PGCNT) % HUGE_PGCNT;
+		if (page_idx != BITMAP_ERROR) {
+			buddy_free (pool, page_idx, huge_idx - page_idx);
+			buddy_free (pool, huge_idx + HUGE_PGCNT,
+					page_idx + HUGE_PGCNT - huge_idx);
+		}
+	}
+	if (page_idx != BITMAP_ERROR) {
+#ifndef NDEBUG
+		ASSERT (bitmap_none (pool->used_map, huge_idx, HUGE_PGCNT));
+		bitmap_set_multiple (pool->used_map, huge_idx, HUGE_PGCNT, true);
+#endif
+		pages = pool->base + PGSIZE * huge_idx;
+	}
+	intr_set_level (old_level);
+
+	if (pages) {
+		if (flags & PAL_ZERO)
+			memset (pages, 0, HUGE_PGSIZE);
+	} else if (flags & PAL_ASSERT)
+		PANIC ("palloc_get_huge_page: out of pages");
+	return pages;
+}
+
 /* Obtains a single free page and returns its kernel virtual
    address.
    If PAL_USER is set, the page is obtained from the user pool,
@@ -301,6 +456,7 @@ void
 palloc_free_multiple (void *pages, size_t page_cnt) {
 	struct pool *pool;
 	size_t page_idx;
+	enum intr_level old_level;
 
 	ASSERT (pg_ofs (pages) == 0);
 	if (pages == NULL || page_cnt == 0)
@@ -318,8 +474,14 @@ palloc_free_multiple (void *pages, size_t page_cnt) {
 #ifndef NDEBUG
 	memset (pages, 0xcc, PGSIZE * page_cnt);
 #endif
+
+	old_level = intr_disable ();
+#ifndef NDEBUG
 	ASSERT (bitmap_all (pool->used_map, page_idx, page_cnt));
 	bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+#endif
+	buddy_free (pool, page_idx, page_cnt);
+	intr_set_level (old_level);
 }
 
 /* Frees the page at PAGE. */
@@ -328,7 +490,8 @@ palloc_free_page (void *page) {
 	palloc_free_multiple (page, 1);
 }
 
-/* Initializes pool P as starting at START and ending at END */
+/* Initializes pool P, called NAME, as starting at START and
+   ending at END */
 static void
 init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end) {
   /* We'll put the pool's used_map at its base.
@@ -336,15 +499,289 @@ init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end) {
      and subtract it from the pool's size. */
 	uint64_t pgcnt = (end - start) / PGSIZE;
 	size_t bm_pages = DIV_ROUND_UP (bitmap_buf_size (pgcnt), PGSIZE) * PGSIZE;
+	size_t elem_bytes = ROUND_UP (pgcnt * sizeof *p->free_elems, PGSIZE);
+	size_t order_bytes = ROUND_UP (pgcnt * sizeof *p->free_order, PGSIZE);
+	int order;
 
-	lock_init(&p->lock);
 	p->used_map = bitmap_create_in_buf (pgcnt, *bm_base, bm_pages);
 	p->base = (void *) start;
+	p->page_cnt = pgcnt;
 
 	// Mark all to unusable.
 	bitmap_set_all(p->used_map, true);
-
 	*bm_base += bm_pages;
+
+	// The buddy lists start out empty; see init_free_lists().
+	for (order = 0; order < ORDER_CNT; order++)
+		list_init (&p->free_lists[order]);
+	list_init (&p->zeroed);
+	p->zeroed_cnt = 0;
+	p->free_cnt = 0;
+	p->zero_hits = p->zero_misses = 0;
+	p->free_elems = *bm_base;
+	*bm_base += elem_bytes;
+	p->free_order = *bm_base;
+	memset (p->free_order, NOT_FREE, pgcnt);
+	*bm_base += order_bytes;
+}
+
+/* Puts every page that populate_pools() marked free in P's used
+   map onto P's buddy lists. */
+static void
+init_free_lists (struct pool *p) {
+	size_t page_idx = 0;
+
+	while (page_idx < p->page_cnt) {
+		size_t run;
+
+		if (bitmap_test (p->used_map, page_idx)) {
+			page_idx++;
+			continue;
+		}
+		for (run = 1; page_idx + run < p->page_cnt; run++)
+			if (bitmap_test (p->used_map, page_idx + run))
+				break;
+		buddy_free (p, page_idx, run);
+		page_idx += run;
+	}
+}
+
+/* Takes PAGE_CNT contiguous pages from POOL, draining the stock
+   of zeroed pages if the free lists alone cannot satisfy it, and
+   returns the index of the first page, or BITMAP_ERROR.  Counts a
+   miss in the zeroed stock if ZERO_MISS. */
+static size_t
+pool_alloc (struct pool *pool, size_t page_cnt, bool zero_miss) {
+	size_t page_idx;
+	enum intr_level old_level;
+
+	old_level = intr_disable ();
+	if (zero_miss)
+		pool->zero_misses++;
+	page_idx = buddy_alloc (pool, page_cnt);
+	if (page_idx == BITMAP_ERROR && pool->zeroed_cnt > 0) {
+		zeroed_drain (pool);
+		page_idx = buddy_alloc (pool, page_cnt);
+	}
+#ifndef NDEBUG
+	if (page_idx != BITMAP_ERROR) {
+		ASSERT (bitmap_none (pool->used_map, page_idx, page_cnt));
+		bitmap_set_multiple (pool->used_map, page_idx, page_cnt, true);
+	}
+#endif
+	intr_set_level (old_level);
+	return page_idx;
+}
+
+/* Returns the smallest order whose blocks hold PAGE_CNT pages. */
+static int
+order_for (size_t page_cnt) {
+	int order = 0;
+
+	while (((size_t) 1 << order) < page_cnt)
+		order++;
+	return order;
+}
+
+/* Removes PAGE_CNT contiguous pages from P's buddy lists and
+   returns the index of the first one, or BITMAP_ERROR if no free
+   block is large enough.  Interrupts must be off. */
+static size_t
+buddy_alloc (struct pool *p, size_t page_cnt) {
+	int want = order_for (page_cnt);
+	size_t page_idx;
+	int order;
+
+	ASSERT (page_cnt > 0);
+
+	for (order = want; order < ORDER_CNT; order++)
+		if (!list_empty (&p->free_lists[order]))
+			break;
+	if (order >= ORDER_CNT)
+		return BITMAP_ERROR;
+
+	page_idx = list_pop_front (&p->free_lists[order]) - p->free_elems;
+	p->free_order[page_idx] = NOT_FREE;
+	p->free_cnt -= (size_t) 1 << want;
+
+	/* Split off upper halves until the block is of order WANT. */
+	while (order > want) {
+		size_t upper;
+
+		order--;
+		upper = page_idx + ((size_t) 1 << order);
+		p->free_order[upper] = order;
+		list_push_front (&p->free_lists[order], &p->free_elems[upper]);
+	}
+
+	/* Give back the pages past PAGE_CNT. */
+	if (page_cnt < (size_t) 1 << want)
+		buddy_free (p, page_idx + page_cnt, ((size_t) 1 << want) - page_cnt);
+	return page_idx;
+}
+
+/* Returns the PAGE_CNT pages starting at PAGE_IDX to P's buddy
+   lists, as the largest aligned blocks that cover them.
+   Interrupts must be off, except during initialization. */
+static void
+buddy_free (struct pool *p, size_t page_idx, size_t page_cnt) {
+	while (page_cnt > 0) {
+		int order = 0;
+
+		while (order + 1 < ORDER_CNT
+				&& (page_idx & ((size_t) 1 << order)) == 0
+				&& ((size_t) 2 << order) <= page_cnt)
+			order++;
+		buddy_free_block (p, page_idx, order);
+		page_idx += (size_t) 1 << order;
+		page_cnt -= (size_t) 1 << order;
+	}
+}
+
+/* Frees the block of order ORDER at PAGE_IDX in P, merging it
+   with its buddy for as long as the buddy is free. */
+static void
+buddy_free_block (struct pool *p, size_t page_idx, int order) {
+	ASSERT ((page_idx & (((size_t) 1 << order) - 1)) == 0);
+	ASSERT (p->free_order[page_idx] == NOT_FREE);
+
+	p->free_cnt += (size_t) 1 << order;
+	while (order + 1 < ORDER_CNT) {
+		size_t buddy = page_idx ^ ((size_t) 1 << order);
+
+		if (buddy >= p->page_cnt || p->free_order[buddy] != order)
+			break;
+		list_remove (&p->free_elems[buddy]);
+		p->free_order[buddy] = NOT_FREE;
+		page_idx &= ~((size_t) 1 << order);
+		order++;
+	}
+
+	p->free_order[page_idx] = order;
+	list_push_front (&p->free_lists[order], &p->free_elems[page_idx]);
+}
+
+/* Takes a page from P's stock of pre-zeroed pages and returns it,
+   or returns a null pointer if the stock is empty, in which case
+   the caller counts the miss.  An empty stock is seen without
+   turning interrupts off.  Wakes the zeroer if the stock is below
+   ZERO_LOW. */
+static void *
+zeroed_take (struct pool *p) {
+	void *page = NULL;
+	size_t left = 0;
+
+	if (p->zeroed_cnt > 0) {
+		enum intr_level old_level = intr_disable ();
+		if (!list_empty (&p->zeroed)) {
+			size_t page_idx = list_pop_front (&p->zeroed) - p->free_elems;
+			page = p->base + PGSIZE * page_idx;
+			p->zeroed_cnt--;
+			p->zero_hits++;
+		}
+		left = p->zeroed_cnt;
+		intr_set_level (old_level);
+	}
+
+	if (left < ZERO_LOW)
+		zeroer_wake ();
+	return page;
+}
+
+/* Wakes the zeroer if it is asleep. */
+static void
+zeroer_wake (void) {
+	enum intr_level old_level = intr_disable ();
+	bool asleep = zeroer_asleep;
+
+	zeroer_asleep = false;
+	intr_set_level (old_level);
+	if (asleep)
+		sema_up (&zero_wake);
+}
+
+/* Gives every page in P's stock of pre-zeroed pages back to the
+   buddy lists.  Interrupts must be off. */
+static void
+zeroed_drain (struct pool *p) {
+	while (!list_empty (&p->zeroed)) {
+		size_t page_idx = list_pop_front (&p->zeroed) - p->free_elems;
+#ifndef NDEBUG
+		bitmap_reset (p->used_map, page_idx);
+#endif
+		buddy_free_block (p, page_idx, 0);
+	}
+	p->zeroed_cnt = 0;
+}
+
+/* Zeroes one free page of P and adds it to P's stock.  Returns
+   false if the stock is full or P is short of free pages. */
+static bool
+zeroed_refill (struct pool *p) {
+	size_t page_idx;
+	enum intr_level old_level;
+
+	old_level = intr_disable ();
+	if (p->zeroed_cnt >= ZERO_TARGET || p->free_cnt < ZERO_FREE_MIN) {
+		intr_set_level (old_level);
+		return false;
+	}
+	page_idx = buddy_alloc (p, 1);
+#ifndef NDEBUG
+	if (page_idx != BITMAP_ERROR)
+		bitmap_mark (p->used_map, page_idx);
+#endif
+	intr_set_level (old_level);
+	if (page_idx == BITMAP_ERROR)
+		return false;
+
+	/* Zero the page with interrupts on. */
+	memset (p->base + PGSIZE * page_idx, 0, PGSIZE);
+
+	old_level = intr_disable ();
+	list_push_front (&p->zeroed, &p->free_elems[page_idx]);
+	p->zeroed_cnt++;
+	intr_set_level (old_level);
+	return true;
+}
+
+/* Thread function for the zeroer.  Keeps both pools' stocks of
+   pre-zeroed pages full, one page at a time, and sleeps on
+   zero_wake when there is nothing to do. */
+static void
+zeroer (void *aux UNUSED) {
+	/* Under the 4.4BSD scheduler, priorities come from niceness,
+	   and idle-time work should not raise the load average. */
+	thread_set_nice (NICE_MAX);
+	thread_set_background ();
+
+	for (;;) {
+		bool kernel_done = !zeroed_refill (&kernel_pool);
+		bool user_done = !zeroed_refill (&user_pool);
+
+		if (kernel_done && user_done) {
+			enum intr_level old_level = intr_disable ();
+			zeroer_asleep = true;
+			sema_down (&zero_wake);
+			intr_set_level (old_level);
+		}
+	}
+}
+
+/* Prints statistics about pre-zeroed pages and the number of
+   free blocks of each order in the kernel pool. */
+void
+palloc_print_stats (void) {
+	int order;
+
+	printf ("Palloc: kernel pool %llu zeroed hits, %llu misses; "
+			"user pool %llu zeroed hits, %llu misses\n",
+			kernel_pool.zero_hits, kernel_pool.zero_misses,
+			user_pool.zero_hits, user_pool.zero_misses);
+	printf ("Palloc: kernel pool free blocks by order:");
+	for (order = 0; order < ORDER_CNT; order++)
+		printf (" %zu", list_size (&kernel_pool.free_lists[order]));
+	printf ("\n");
 }
 
 /* Returns true if PAGE was allocated from POOL,
@@ -353,6 +790,6 @@ static bool
 page_from_pool (const struct pool *pool, void *page) {
 	size_t page_no = pg_no (page);
 	size_t start_page = pg_no (pool->base);
-	size_t end_page = start_page + bitmap_size (pool->used_map);
+	size_t end_page = start_page + pool->page_cnt;
 	return page_no >= start_page && page_no < end_page;
 }
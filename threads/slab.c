@@ -0,0 +1,238 @@
+#include "threads/slab.h"
+#include <debug.h>
+#include <round.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
+
+/* Slab allocator, after Bonwick, "The Slab Allocator: An
+   Object-Caching Kernel Memory Allocator" (USENIX 1994).
+
+   Each cache hands out objects of one size.  It gets memory from
+   the page allocator one page, called a "slab", at a time.  A
+   slab starts with a struct slab, followed by a stack of the
+   indexes of its free objects, followed by the objects.  Keeping
+   the free stack apart from the objects means that a free object
+   keeps whatever its constructor put in it.
+
+   The space left over at the end of a page is used for "cache
+   coloring": successive slabs start their objects ALIGN bytes
+   further into the page, wrapping around, so that the same
+   object in different slabs does not always map to the same CPU
+   cache lines.
+
+   Each cache keeps its slabs on three lists, by how many of their
+   objects are in use.  kmem_cache_alloc() takes from a partial
+   slab if there is one, so that objects are packed into as few
+   pages as possible.  A cache keeps one empty slab to absorb
+   alloc/free churn and returns any others to the page
+   allocator. */
+
+/* Magic number for detecting slab corruption. */
+#define SLAB_MAGIC 0x51ab51ab
+
+/* Slab header, at the start of each slab's page. */
+struct slab {
+	unsigned magic;             /* Always set to SLAB_MAGIC. */
+	struct kmem_cache *cache;   /* Owning cache. */
+	struct list_elem elem;      /* Element in one of the cache's lists. */
+	uint8_t *objs;              /* First object. */
+	size_t free_cnt;            /* Number of free objects. */
+	uint16_t free[];            /* Free object indexes, top at
+	                               free[free_cnt - 1]. */
+};
+
+/* List of all caches, for kmem_print_stats(). */
+static struct list all_caches;
+
+static struct slab *slab_create (struct kmem_cache *);
+static struct slab *obj_to_slab (struct kmem_cache *, void *);
+
+/* Initializes the slab allocator. */
+void
+slab_init (void) {
+	list_init (&all_caches);
+}
+
+/* Returns the offset of the first object in a slab of a cache
+   with OBJ_CNT objects of the given ALIGNment, before coloring. */
+static size_t
+objs_offset (size_t obj_cnt, size_t align) {
+	return ROUND_UP (sizeof (struct slab) + obj_cnt * sizeof (uint16_t),
+			align);
+}
+
+/* Initializes CACHE, called NAME, to hand out objects of SIZE
+   bytes aligned on ALIGN bytes, which must be a power of 2, or 0
+   for pointer alignment.  If CTOR is nonnull, it is run on each
+   object when it is first created.  SIZE must be small enough
+   for a page to hold at least a few objects. */
+void
+kmem_cache_init (struct kmem_cache *cache, const char *name,
+		size_t size, size_t align, kmem_ctor_func *ctor) {
+	size_t n;
+
+	ASSERT (cache != NULL);
+	ASSERT (size > 0);
+	if (align == 0)
+		align = sizeof (void *);
+	ASSERT ((align & (align - 1)) == 0);
+
+	cache->name = name;
+	cache->align = align;
+	cache->obj_size = ROUND_UP (size, align);
+	cache->ctor = ctor;
+
+	/* Fit as many objects as the page holds, counting the free
+	   stack entry that each one needs. */
+	n = (PGSIZE - sizeof (struct slab))
+		/ (cache->obj_size + sizeof (uint16_t));
+	while (n > 0 && objs_offset (n, align) + n * cache->obj_size > PGSIZE)
+		n--;
+	ASSERT (n >= 2);
+	cache->objs_per_slab = n;
+	cache->color_max = PGSIZE - objs_offset (n, align) - n * cache->obj_size;
+	cache->color_max -= cache->color_max % align;
+	cache->color_next = 0;
+
+	lock_init_named (&cache->lock, name);
+	list_init (&cache->partial_slabs);
+	list_init (&cache->full_slabs);
+	list_init (&cache->empty_slabs);
+	cache->slab_cnt = 0;
+	cache->obj_cnt = 0;
+
+	list_push_back (&all_caches, &cache->elem);
+}
+
+/* Allocates and returns an object from CACHE, in the state its
+   constructor or its last user left it.  Returns a null pointer
+   if memory is not available. */
+void *
+kmem_cache_alloc (struct kmem_cache *cache) {
+	struct slab *s;
+	void *obj;
+
+	lock_acquire (&cache->lock);
+	if (!list_empty (&cache->partial_slabs))
+		s = list_entry (list_front (&cache->partial_slabs), struct slab, elem);
+	else if (!list_empty (&cache->empty_slabs)) {
+		s = list_entry (list_pop_front (&cache->empty_slabs), struct slab, elem);
+		list_push_front (&cache->partial_slabs, &s->elem);
+	} else {
+		s = slab_create (cache);
+		if (s == NULL) {
+			lock_release (&cache->lock);
+			return NULL;
+		}
+		list_push_front (&cache->partial_slabs, &s->elem);
+	}
+
+	obj = s->objs + s->free[--s->free_cnt] * cache->obj_size;
+	if (s->free_cnt == 0) {
+		list_remove (&s->elem);
+		list_push_front (&cache->full_slabs, &s->elem);
+	}
+	cache->obj_cnt++;
+	lock_release (&cache->lock);
+
+	return obj;
+}
+
+/* Returns OBJ, which must have come from CACHE, to CACHE. */
+void
+kmem_cache_free (struct kmem_cache *cache, void *obj) {
+	struct slab *s;
+	struct slab *spare = NULL;
+
+	if (obj == NULL)
+		return;
+
+	s = obj_to_slab (cache, obj);
+
+	lock_acquire (&cache->lock);
+	ASSERT (s->free_cnt < cache->objs_per_slab);
+	s->free[s->free_cnt++] = ((uint8_t *) obj - s->objs) / cache->obj_size;
+	cache->obj_cnt--;
+
+	if (s->free_cnt == 1 || s->free_cnt == cache->objs_per_slab) {
+		list_remove (&s->elem);
+		if (s->free_cnt < cache->objs_per_slab)
+			list_push_front (&cache->partial_slabs, &s->elem);
+		else if (list_empty (&cache->empty_slabs))
+			list_push_front (&cache->empty_slabs, &s->elem);
+		else {
+			spare = s;
+			cache->slab_cnt--;
+		}
+	}
+	lock_release (&cache->lock);
+
+	if (spare != NULL) {
+		spare->magic = 0;
+		palloc_free_page (spare);
+	}
+}
+
+/* Prints the object and slab counts of every cache. */
+void
+kmem_print_stats (void) {
+	struct list_elem *e;
+
+	for (e = list_begin (&all_caches); e != list_end (&all_caches);
+			e = list_next (e)) {
+		struct kmem_cache *c = list_entry (e, struct kmem_cache, elem);
+		printf ("Slab %s: %zu objects of %zu bytes in use, %zu slabs "
+				"of %zu\n", c->name, c->obj_cnt, c->obj_size,
+				c->slab_cnt, c->objs_per_slab);
+	}
+}
+
+/* Allocates a new slab for CACHE and constructs its objects.
+   CACHE's lock must be held. */
+static struct slab *
+slab_create (struct kmem_cache *cache) {
+	struct slab *s;
+	size_t i;
+
+	ASSERT (lock_held_by_current_thread (&cache->lock));
+
+	s = palloc_get_page (0);
+	if (s == NULL)
+		return NULL;
+
+	s->magic = SLAB_MAGIC;
+	s->cache = cache;
+	s->objs = (uint8_t *) s + objs_offset (cache->objs_per_slab, cache->align)
+		+ cache->color_next;
+	s->free_cnt = cache->objs_per_slab;
+	for (i = 0; i < cache->objs_per_slab; i++) {
+		/* Hand out low addresses first. */
+		s->free[i] = cache->objs_per_slab - 1 - i;
+		if (cache->ctor != NULL)
+			cache->ctor (s->objs + i * cache->obj_size);
+	}
+
+	cache->color_next += cache->align;
+	if (cache->color_next > cache->color_max)
+		cache->color_next = 0;
+	cache->slab_cnt++;
+	return s;
+}
+
+/* Returns the slab that OBJ, from CACHE, is inside. */
+static struct slab *
+obj_to_slab (struct kmem_cache *cache, void *obj) {
+	struct slab *s = pg_round_down (obj);
+
+	/* Check that the slab is valid. */
+	ASSERT (s->magic == SLAB_MAGIC);
+	ASSERT (s->cache == cache);
+
+	/* Check that the object is properly aligned for the slab. */
+	ASSERT ((uint8_t *) obj >= s->objs);
+	ASSERT (((uint8_t *) obj - s->objs) % cache->obj_size == 0);
+
+	return s;
+}
@@ -2,22 +2,46 @@
 #include <stdio.h>
 #include <string.h>
 #include "threads/interrupt.h"
+#include "threads/malloc.h"
 #include "threads/thread.h"
+#include "intrinsic.h"
 /* --------------------[project1]-----------------------*/
-void donate_priority(void);
-void remove_with_lock(struct lock *lock);
 void refresh_priority(void);
 
-bool sem_priority_less(const struct list_elem *a, const struct list_elem *b, void *aux);
-bool donate_priority_less(struct list_elem *a, struct list_elem *b, void *aux);
+static bool waiter_priority_greater(const struct heap_elem *a, const struct heap_elem *b, void *aux);
+static bool cond_waiter_greater(const struct heap_elem *a, const struct heap_elem *b, void *aux);
+static void lock_take(struct lock *lock);
+static void lock_raise(struct lock *lock, int priority);
+static void donate_to(struct thread *t, int priority);
 /* --------------------[project1]-----------------------*/
 
+/* Maximum number of distinct lock names counted by -lockprof.
+   Names beyond that are not counted. */
+#define LOCK_STAT_MAX 64
+
+bool lock_profiling;
+static struct lock_stat lock_stats[LOCK_STAT_MAX];
+static int lock_stat_cnt;
+
+static struct lock_stat *lock_stat_get(const char *name);
+static void lock_stat_acquired(struct lock *lock, uint64_t start, bool contended);
+static void lock_stat_released(struct lock *lock);
+
+static void donate_chain(struct thread *holder, int priority);
+static struct rwlock_hold *rwlock_hold_create(struct rwlock *rw);
+static void rwlock_wait(struct rwlock_hold *hold, struct heap *waiters);
+static void rwlock_raise(struct rwlock *rw, int priority);
+static void rwlock_grant(struct rwlock *rw);
+static void rwlock_add_holder(struct rwlock_hold *hold);
+static struct rwlock_hold *rwlock_remove_holder(struct rwlock *rw);
+static int rwlock_max_waiter_priority(struct rwlock *rw);
+
 void sema_init(struct semaphore *sema, unsigned value)
 {
 	ASSERT(sema != NULL);
 
 	sema->value = value;
-	list_init(&sema->waiters);
+	heap_init(&sema->waiters, waiter_priority_greater, NULL);
 }
 
 void sema_down(struct semaphore *sema)
@@ -30,8 +54,17 @@ void sema_down(struct semaphore *sema)
 	old_level = intr_disable();
 	while (sema->value == 0) /* sema에 접근할 수 없을 때 */
 	{
-		list_insert_ordered(&sema->waiters, &thread_current()->elem, &priority_less, NULL); /* 접근 권한이 생기기를 기다리는 스레드를 waiters에 추가 */
-		thread_block();																		   /* 해당 스레드 block */
+		struct thread *curr = thread_current();
+
+		/* Wait in the priority heap.  Coming from cond_wait(), the
+		   condition's heap already orders us, so leave wait_heap alone. */
+		heap_insert(&sema->waiters, &curr->wait_elem);
+		if (curr->wait_heap == NULL)
+		{
+			curr->wait_heap = &sema->waiters;
+			curr->wait_heap_elem = &curr->wait_elem;
+		}
+		thread_block(); /* 해당 스레드 block */
 	}
 	sema->value--;
 	intr_set_level(old_level);
@@ -64,11 +97,14 @@ void sema_up(struct semaphore *sema)
 	ASSERT(sema != NULL);
 
 	old_level = intr_disable();
-	if (!list_empty(&sema->waiters))
+	if (!heap_empty(&sema->waiters))
 	{
-		list_sort(&sema->waiters, &priority_less, NULL); /* 우선 순위가 변경됐을 경우 waiters 정렬 */
-		thread_unblock(list_entry(list_pop_front(&sema->waiters),
-								  struct thread, elem)); /* prioirty가 가장 높은 스레드를 unblock */
+		/* Donations reposition waiters, so the top has the highest priority. */
+		struct thread *t = heap_entry(heap_pop(&sema->waiters), struct thread, wait_elem);
+
+		if (t->wait_heap == &sema->waiters)
+			t->wait_heap = NULL;
+		thread_unblock(t);
 	}
 	sema->value++;
 	test_max_priority();
@@ -107,77 +143,99 @@ sema_test_helper(void *sema_)
 	}
 }
 
-void lock_init(struct lock *lock)
+void lock_init_named(struct lock *lock, const char *name)
 {
 	ASSERT(lock != NULL);
+	ASSERT(name != NULL);
 
 	lock->holder = NULL;
 	sema_init(&lock->semaphore, 1);
+	lock->held.max_priority = PRI_MIN - 1;
+	lock->name = name;
+	lock->stat = lock_profiling ? lock_stat_get(name) : NULL;
+	lock->taken_tsc = 0;
 }
 
 /* lock을 요구한 thread_current에 lock을 주는 함수 */
 void lock_acquire(struct lock *lock)
 {
+	struct thread *curr = thread_current();
+	enum intr_level old_level;
+	uint64_t start;
+	bool contended;
+
 	ASSERT(lock != NULL);
 	ASSERT(!intr_context());
 	ASSERT(!lock_held_by_current_thread(lock));
 
-	// ******************************LINE ADDED****************************** //
-	// Project 1-2.3 : Priority Inversion Problem - Priority Donation
-	// LOCK이 Holder를 가지고 있는지. 즉, LOCK이 점유되고 있는지 Check.
-	// 다른 스레드가 LOCK을 점유하고 있으면 자신의 Priority를 Donation 하여
-	// 현재 LOCK을 점유하는 스레드가 우선적으로 LOCK을 반환하도록 한다.
-	// !CAUTION : lock_acquire 함수 내에서는 thread_current()는 LOCK을 얻고자 하는 스레드를 current로 취급한다.
-	//            또한, lock_acquire 함수를 호출 할 수 있었다는 것은 지금 lock->holder 스레드 보다 priority가 높다는 것을 의미
-	//            따라서 우선 순위의 대소 비교를 할 필요가 없다.
-
-	/*if (lock -> holder != NULL){*/
-	if (lock->holder)
-	{
-		thread_current()->wait_on_lock = lock; // 현재 스레드가 LOCK을 기다리고 있다고 알려준다.
-		// donations 리스트에 넣어줄때는 FIFO(기부 순서)가 아닌 priority순으로 정렬하여 삽입
-		// -> donor들이 나갈때도 priority 순으로 나가기 때문에.
+	start = lock->stat != NULL ? rdtsc() : 0;
 
-		list_insert_ordered(&lock->holder->donations, &thread_current()->donation_elem, &donate_priority_less, NULL);
-		/*list_push_back(&lock->holder->donations, &curr->donation_elem);*/
-		donate_priority();
+	/* Take a free lock without going through donation.  Pintos
+	   runs on one CPU, so a holder is never running while we
+	   are, and spinning for it could only waste the slice. */
+	contended = !sema_try_down(&lock->semaphore);
+	if (!contended)
+	{
+		old_level = intr_disable();
+		lock_take(lock);
 	}
-	// *************************ADDED LINE ENDS HERE************************* //
-
-	sema_down(&lock->semaphore);
-	lock->holder = thread_current();
-
-	// ******************************LINE ADDED****************************** //
-	// Project 1-2.3 : Priority Inversion Problem - Priority Donation
-	thread_current()->wait_on_lock = NULL;
-	// *************************ADDED LINE ENDS HERE************************* //
+	else
+	{
+		/* 다른 스레드가 LOCK을 점유하고 있으면 자신의 priority를 donation 하여
+		   LOCK을 점유하는 스레드가 우선적으로 LOCK을 반환하도록 한다.
+		   -mlfqs 에서는 priority donation을 하지 않는다. */
+		old_level = intr_disable();
+		curr->wait_on_lock = lock;
+		if (!thread_mlfqs)
+			lock_raise(lock, curr->priority);
+
+		sema_down(&lock->semaphore);
+		curr->wait_on_lock = NULL;
+		lock_take(lock);
+	}
+	if (lock->stat != NULL)
+		lock_stat_acquired(lock, start, contended);
+	intr_set_level(old_level);
 }
 
 bool lock_try_acquire(struct lock *lock)
 {
+	enum intr_level old_level;
 	bool success;
 
 	ASSERT(lock != NULL);
 	ASSERT(!lock_held_by_current_thread(lock));
 
+	old_level = intr_disable();
 	success = sema_try_down(&lock->semaphore);
 	if (success)
-		lock->holder = thread_current();
+	{
+		lock_take(lock);
+		if (lock->stat != NULL)
+			lock_stat_acquired(lock, rdtsc(), false);
+	}
+	intr_set_level(old_level);
 	return success;
 }
 
 /* 다 쓴 lock을 해제하는 함수 */
 void lock_release(struct lock *lock)
 {
+	enum intr_level old_level;
+
 	ASSERT(lock != NULL);
 	ASSERT(lock_held_by_current_thread(lock));
 
-	remove_with_lock(lock);
-	refresh_priority();
+	old_level = intr_disable();
+	if (lock->stat != NULL)
+		lock_stat_released(lock);
+	heap_remove(&thread_current()->held_locks, &lock->held.elem);
+	if (!thread_mlfqs)
+		refresh_priority();
 	lock->holder = NULL; /* lock의 holder 초기화 */
+	intr_set_level(old_level);
 
 	sema_up(&lock->semaphore);
-
 }
 
 bool lock_held_by_current_thread(const struct lock *lock)
@@ -187,53 +245,225 @@ bool lock_held_by_current_thread(const struct lock *lock)
 	return lock->holder == thread_current();
 }
 
-/* --------------------[project1]-----------------------*/
-/* 현재 스레드가 lock을 기다리고 있는 경우, lock을 보유하고 있는 다른 스레드의 우선순위를 현재 스레드의 우선순위로 업데이트(donation)하는 함수 */
-void donate_priority(void)
+/* ===============================[lock profiling]=============================== */
+/* With -lockprof, counts acquisitions, contended acquisitions and
+   wait and hold times for each lock.  Locks with the same name
+   (e.g. "&lock" made on the stack) share one lock_stat. */
+
+/* Finds or creates the lock_stat for NAME.  Returns NULL if the
+   table is full. */
+static struct lock_stat *
+lock_stat_get(const char *name)
 {
-	struct thread *cur = thread_current();
-	int depth;
-	for (depth = 0; depth < 8; depth++) /* nested donation의 제한 */
-	{
-		if (!cur->wait_on_lock) /* 현재 탐색 중인 스레드가 필요로 하는 락이 없으면(종료 지점) */
+	struct lock_stat *stat = NULL;
+	enum intr_level old_level = intr_disable();
+
+	for (int i = 0; i < lock_stat_cnt; i++)
+		if (!strcmp(lock_stats[i].name, name))
+		{
+			stat = &lock_stats[i];
 			break;
+		}
+	if (stat == NULL && lock_stat_cnt < LOCK_STAT_MAX)
+	{
+		stat = &lock_stats[lock_stat_cnt++];
+		stat->name = name;
+	}
+
+	intr_set_level(old_level);
+	return stat;
+}
+
+/* Records that LOCK was just taken by a lock_acquire() that
+   started at START. */
+static void
+lock_stat_acquired(struct lock *lock, uint64_t start, bool contended)
+{
+	struct lock_stat *stat = lock->stat;
+	uint64_t now = rdtsc();
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	stat->acquisitions++;
+	if (contended)
+	{
+		uint64_t wait = now - start;
 
-		struct thread *holder = cur->wait_on_lock->holder;
-		holder->priority = cur->priority; /* priority donation */
-		cur = holder;					  /* 필요한 lock의 holder를 탐색 스레드로 설정 */
+		stat->contended++;
+		stat->wait_cycles += wait;
+		if (wait > stat->max_wait_cycles)
+			stat->max_wait_cycles = wait;
 	}
+	lock->taken_tsc = now;
+}
+
+/* Records LOCK's hold time just before it is released. */
+static void
+lock_stat_released(struct lock *lock)
+{
+	struct lock_stat *stat = lock->stat;
+	uint64_t hold = rdtsc() - lock->taken_tsc;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	stat->hold_cycles += hold;
+	if (hold > stat->max_hold_cycles)
+		stat->max_hold_cycles = hold;
 }
 
-/* 인자 lock을 기다리고 있는 스레드를 donations에서 제거하는 함수 */
-void remove_with_lock(struct lock *lock)
+/* Prints the statistics, longest total wait first. */
+void lock_print_stats(void)
+{
+	struct lock_stat *sorted[LOCK_STAT_MAX];
+	int cnt = 0;
+
+	if (!lock_profiling)
+		return;
+
+	/* Insertion sort by descending total wait. */
+	for (int i = 0; i < lock_stat_cnt; i++)
+	{
+		struct lock_stat *stat = &lock_stats[i];
+		int j;
+
+		if (stat->acquisitions == 0)
+			continue;
+		for (j = cnt; j > 0 && sorted[j - 1]->wait_cycles < stat->wait_cycles; j--)
+			sorted[j] = sorted[j - 1];
+		sorted[j] = stat;
+		cnt++;
+	}
+
+	printf("Lock contention, by total wait (TSC cycles):\n");
+	printf("%-20s %10s %10s %14s %12s %12s %12s\n", "lock", "acquires",
+		   "contended", "total wait", "max wait", "avg hold", "max hold");
+	for (int i = 0; i < cnt; i++)
+	{
+		struct lock_stat *s = sorted[i];
+		printf("%-20s %10lld %10lld %14llu %12llu %12llu %12llu\n", s->name,
+			   s->acquisitions, s->contended, s->wait_cycles, s->max_wait_cycles,
+			   s->hold_cycles / s->acquisitions, s->max_hold_cycles);
+	}
+}
+
+/* --------------------[project1]-----------------------*/
+/* Priority donation.
+ *
+ * Each lock remembers the highest priority among the threads
+ * waiting for it as max_priority, and each thread keeps the locks
+ * it holds in a max-heap on max_priority (held_locks).  Each held
+ * rwlock goes into the same heap through its rwlock_hold.  A
+ * thread's priority is then the larger of init_priority and the
+ * top of held_locks, so lock_release() need not walk a list of
+ * donations: taking one lock out of the heap is O(log n). */
+
+/* Records that the current thread took LOCK.  The semaphore's
+   waiters are a max-heap on priority, so the top is the highest
+   priority still waiting. */
+static void
+lock_take(struct lock *lock)
 {
-	struct list_elem *find; /* 탐색 포인터 */
 	struct thread *curr = thread_current();
+	struct heap *waiters = &lock->semaphore.waiters;
+
+	ASSERT(intr_get_level() == INTR_OFF);
 
-	for (find = list_begin(&curr->donations); find != list_end(&curr->donations); find = list_next(find))
+	lock->holder = curr;
+	lock->held.max_priority = heap_empty(waiters)
+								  ? PRI_MIN - 1
+								  : heap_entry(heap_top(waiters), struct thread, wait_elem)->priority;
+	heap_insert(&curr->held_locks, &lock->held.elem);
+	if (!thread_mlfqs && lock->held.max_priority > curr->priority)
+		curr->priority = lock->held.max_priority;
+}
+
+/* Raises LOCK's max_priority and its holder's priority to PRIORITY,
+   now that a thread waiting for LOCK has it.  If the holder is in
+   turn waiting for a lock or rwlock, continues there (nested
+   donation).  There is no depth limit: the walk stops wherever the
+   priority no longer rises. */
+static void
+lock_raise(struct lock *lock, int priority)
+{
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	while (lock != NULL && lock->held.max_priority < priority)
 	{
-		struct thread *t = list_entry(find, struct thread, donation_elem);
-		if (t->wait_on_lock == lock) /* 인자 lock을 기다리고 있는 스레드 */
+		struct thread *holder = lock->holder;
+
+		lock->held.max_priority = priority;
+		if (holder == NULL)
+			break;
+		heap_update(&holder->held_locks, &lock->held.elem);
+		if (holder->priority >= priority)
+			break;
+		donate_to(holder, priority);
+		if (holder->wait_on_rwlock != NULL)
 		{
-			list_remove(find); /* donations에서 삭제 */
+			rwlock_raise(holder->wait_on_rwlock->rwlock, priority);
+			break;
 		}
+		lock = holder->wait_on_lock;
 	}
 }
 
-/* 현재 스레드의 우선순위를 donations의 최댓값의 우선순위와 비교해서 큰 값으로 업데이트하는 함수 */
+/* Raises T's priority to PRIORITY.  If T is waiting on a semaphore,
+   condition or rwlock, also fixes its position in that heap. */
+static void
+donate_to(struct thread *t, int priority)
+{
+	thread_change_priority(t, priority);
+	t->stats.donations++;
+	if (t->wait_heap != NULL)
+		heap_update(t->wait_heap, t->wait_heap_elem);
+}
+
+/* Donates PRIORITY to HOLDER and, if HOLDER is waiting for a lock
+   or rwlock, on to whoever holds that (nested donation). */
+static void
+donate_chain(struct thread *holder, int priority)
+{
+	if (holder->priority >= priority)
+		return;
+	donate_to(holder, priority);
+	if (holder->wait_on_rwlock != NULL)
+		rwlock_raise(holder->wait_on_rwlock->rwlock, priority);
+	else
+		lock_raise(holder->wait_on_lock, priority);
+}
+
+/* Recomputes the current thread's priority as the largest of its
+   init_priority and the donations it still receives. */
 void refresh_priority(void)
 {
 	struct thread *curr = thread_current();
+	enum intr_level old_level = intr_disable();
+
 	curr->priority = curr->init_priority;
 
-	if (!list_empty(&curr->donations))
+	if (!heap_empty(&curr->held_locks))
 	{
-		list_sort(&curr->donations, &donate_priority_less, 0);
-
-		struct thread *front = list_entry(list_front(&curr->donations), struct thread, donation_elem);
-		if (front->priority > curr->priority)
-			curr->priority = front->priority; /* 현재 스레드와 donations의 최댓값 중 큰 값으로 업데이트 */
+		struct held_lock *top = heap_entry(heap_top(&curr->held_locks), struct held_lock, elem);
+		if (top->max_priority > curr->priority)
+			curr->priority = top->max_priority;
 	}
+
+	intr_set_level(old_level);
+}
+
+/* Comparison for held_locks: puts the lock with the highest
+   max_priority on top. */
+bool lock_priority_greater(const struct heap_elem *a, const struct heap_elem *b, void *aux UNUSED)
+{
+	return heap_entry(a, struct held_lock, elem)->max_priority > heap_entry(b, struct held_lock, elem)->max_priority;
+}
+
+/* Comparison for semaphore and rwlock waiters: puts the thread with
+   the highest priority on top. */
+static bool
+waiter_priority_greater(const struct heap_elem *a, const struct heap_elem *b, void *aux UNUSED)
+{
+	return heap_entry(a, struct thread, wait_elem)->priority > heap_entry(b, struct thread, wait_elem)->priority;
 }
 /* --------------------[project1]-----------------------*/
 
@@ -241,20 +471,23 @@ void refresh_priority(void)
 
 struct semaphore_elem
 {
-	struct list_elem elem;
-	struct semaphore semaphore;
+	struct heap_elem elem;		/* Element in the condition's waiters. */
+	struct semaphore semaphore; /* Semaphore the waiter blocks on. */
+	struct thread *thread;		/* Waiting thread. */
 };
 
 void cond_init(struct condition *cond)
 {
 	ASSERT(cond != NULL);
 
-	list_init(&cond->waiters);
+	heap_init(&cond->waiters, cond_waiter_greater, NULL);
 }
 
 void cond_wait(struct condition *cond, struct lock *lock)
 {
+	struct thread *curr = thread_current();
 	struct semaphore_elem waiter;
+	enum intr_level old_level;
 
 	ASSERT(cond != NULL);
 	ASSERT(lock != NULL);
@@ -262,9 +495,16 @@ void cond_wait(struct condition *cond, struct lock *lock)
 	ASSERT(lock_held_by_current_thread(lock));
 
 	sema_init(&waiter.semaphore, 0);
-	waiter.semaphore.priority = thread_current()->priority;
+	waiter.thread = curr;
+
+	/* donate_to() applies donations received while waiting to the
+	   condition's heap. */
+	old_level = intr_disable();
+	heap_insert(&cond->waiters, &waiter.elem);
+	curr->wait_heap = &cond->waiters;
+	curr->wait_heap_elem = &waiter.elem;
+	intr_set_level(old_level);
 
-	list_insert_ordered(&cond->waiters, &waiter.elem, &sem_priority_less, NULL);
 	lock_release(lock);
 	sema_down(&waiter.semaphore);
 	lock_acquire(lock);
@@ -272,18 +512,22 @@ void cond_wait(struct condition *cond, struct lock *lock)
 
 void cond_signal(struct condition *cond, struct lock *lock)
 {
+	enum intr_level old_level;
+
 	ASSERT(cond != NULL);
 	ASSERT(lock != NULL);
 	ASSERT(!intr_context());
 	ASSERT(lock_held_by_current_thread(lock));
 
-	if (!list_empty(&cond->waiters))
+	old_level = intr_disable();
+	if (!heap_empty(&cond->waiters))
 	{
-		// list_sort(&cond->waiters, sem_priority_less, NULL);
-		sema_up(&list_entry(list_pop_front(&cond->waiters),
-							struct semaphore_elem, elem)
-					 ->semaphore);
+		struct semaphore_elem *waiter = heap_entry(heap_pop(&cond->waiters),
+												   struct semaphore_elem, elem);
+		waiter->thread->wait_heap = NULL;
+		sema_up(&waiter->semaphore);
 	}
+	intr_set_level(old_level);
 }
 
 void cond_broadcast(struct condition *cond, struct lock *lock)
@@ -291,24 +535,278 @@ void cond_broadcast(struct condition *cond, struct lock *lock)
 	ASSERT(cond != NULL);
 	ASSERT(lock != NULL);
 
-	while (!list_empty(&cond->waiters))
+	while (!heap_empty(&cond->waiters))
 		cond_signal(cond, lock);
 }
 
-bool sem_priority_less(const struct list_elem *a, const struct list_elem *b, void *aux){
-	struct semaphore_elem *a_sema = list_entry(a, struct semaphore_elem, elem);
-	struct semaphore_elem *b_sema = list_entry(b, struct semaphore_elem, elem);
+/* Comparison for condition waiters: compares the waiting threads'
+   current priorities. */
+static bool
+cond_waiter_greater(const struct heap_elem *a, const struct heap_elem *b, void *aux UNUSED)
+{
+	return heap_entry(a, struct semaphore_elem, elem)->thread->priority > heap_entry(b, struct semaphore_elem, elem)->thread->priority;
+}
+
+/* ===============================[rwlock]=============================== */
+void rwlock_init(struct rwlock *rw)
+{
+	ASSERT(rw != NULL);
+
+	rw->readers = 0;
+	rw->writer = NULL;
+	list_init(&rw->holders);
+	heap_init(&rw->read_waiters, waiter_priority_greater, NULL);
+	heap_init(&rw->write_waiters, waiter_priority_greater, NULL);
+}
+
+/* Acquires RW shared, waiting while a writer holds it or is
+   waiting for it (writers go first).  The current thread must not
+   already hold RW. */
+void rwlock_acquire_read(struct rwlock *rw)
+{
+	struct rwlock_hold *hold;
+	enum intr_level old_level;
+
+	ASSERT(rw != NULL);
+	ASSERT(!intr_context());
+	ASSERT(!rwlock_held_by_current_thread(rw));
+
+	hold = rwlock_hold_create(rw);
+	old_level = intr_disable();
+	if (rw->writer != NULL || !heap_empty(&rw->write_waiters))
+		rwlock_wait(hold, &rw->read_waiters);
+	else
+	{
+		rw->readers++;
+		rwlock_add_holder(hold);
+	}
+	intr_set_level(old_level);
+}
+
+void rwlock_release_read(struct rwlock *rw)
+{
+	struct rwlock_hold *hold;
+	enum intr_level old_level;
+
+	ASSERT(rw != NULL);
+	ASSERT(rw->readers > 0 && rw->writer == NULL);
+	ASSERT(rwlock_held_by_current_thread(rw));
+
+	old_level = intr_disable();
+	rw->readers--;
+	hold = rwlock_remove_holder(rw);
+	if (rw->readers == 0)
+		rwlock_grant(rw);
+	if (!thread_mlfqs)
+		refresh_priority();
+	intr_set_level(old_level);
+
+	free(hold);
+	test_max_priority();
+}
+
+/* Acquires RW exclusively. */
+void rwlock_acquire_write(struct rwlock *rw)
+{
+	struct rwlock_hold *hold;
+	enum intr_level old_level;
+
+	ASSERT(rw != NULL);
+	ASSERT(!intr_context());
+	ASSERT(!rwlock_held_by_current_thread(rw));
+
+	hold = rwlock_hold_create(rw);
+	old_level = intr_disable();
+	if (rw->writer != NULL || rw->readers > 0)
+		rwlock_wait(hold, &rw->write_waiters);
+	else
+	{
+		rw->writer = thread_current();
+		rwlock_add_holder(hold);
+	}
+	intr_set_level(old_level);
+}
+
+void rwlock_release_write(struct rwlock *rw)
+{
+	struct rwlock_hold *hold;
+	enum intr_level old_level;
+
+	ASSERT(rw != NULL);
+	ASSERT(rw->writer == thread_current());
+
+	old_level = intr_disable();
+	rw->writer = NULL;
+	hold = rwlock_remove_holder(rw);
+	rwlock_grant(rw);
+	if (!thread_mlfqs)
+		refresh_priority();
+	intr_set_level(old_level);
+
+	free(hold);
+	test_max_priority();
+}
+
+/* Returns true if the current thread holds RW, shared or
+   exclusively. */
+bool rwlock_held_by_current_thread(const struct rwlock *rw)
+{
+	struct thread *curr = thread_current();
+	struct list_elem *e;
+
+	ASSERT(rw != NULL);
+
+	if (rw->writer == curr)
+		return true;
+	for (e = list_begin(&curr->rw_holds); e != list_end(&curr->rw_holds); e = list_next(e))
+		if (list_entry(e, struct rwlock_hold, thread_elem)->rwlock == rw)
+			return true;
+	return false;
+}
+
+/* Allocates the current thread's hold on RW.  This happens before
+   interrupts are turned off, because malloc() may sleep, so that
+   rwlock_grant() can hand RW to a waiter without allocating. */
+static struct rwlock_hold *
+rwlock_hold_create(struct rwlock *rw)
+{
+	struct rwlock_hold *hold = malloc(sizeof *hold);
+
+	if (hold == NULL)
+		PANIC("rwlock: out of memory");
+	hold->rwlock = rw;
+	hold->thread = thread_current();
+	return hold;
+}
+
+/* Puts the current thread in WAITERS, donates its priority to
+   every holder of HOLD's rwlock, and blocks.  On wakeup
+   rwlock_grant() has already given the rwlock to us through HOLD.
+   Interrupts must be off. */
+static void
+rwlock_wait(struct rwlock_hold *hold, struct heap *waiters)
+{
+	struct thread *curr = hold->thread;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	heap_insert(waiters, &curr->wait_elem);
+	curr->wait_heap = waiters;
+	curr->wait_heap_elem = &curr->wait_elem;
+	curr->wait_on_rwlock = hold;
+	if (!thread_mlfqs)
+		rwlock_raise(hold->rwlock, curr->priority);
+	thread_block();
+}
+
+/* Raises every holder of RW to PRIORITY, now that a thread waiting
+   for RW has it, and follows each holder's own wait onward. */
+static void
+rwlock_raise(struct rwlock *rw, int priority)
+{
+	struct list_elem *e;
 
-	// struct list *waiter_a_sema = &(a_sema->semaphore.waiters);
-	// struct list *waiter_b_sema = &(b_sema->semaphore.waiters);
+	ASSERT(intr_get_level() == INTR_OFF);
 
-	// return list_entry(list_begin(waiter_a_sema), struct thread, elem)->priority > list_entry(list_begin(waiter_b_sema), struct thread, elem)->priority;
-	return a_sema->semaphore.priority > b_sema->semaphore.priority;
+	for (e = list_begin(&rw->holders); e != list_end(&rw->holders); e = list_next(e))
+	{
+		struct rwlock_hold *hold = list_entry(e, struct rwlock_hold, elem);
+
+		if (hold->held.max_priority < priority)
+		{
+			hold->held.max_priority = priority;
+			heap_update(&hold->thread->held_locks, &hold->held.elem);
+		}
+		donate_chain(hold->thread, priority);
+	}
 }
 
-bool donate_priority_less(struct list_elem *a, struct list_elem *b, void *aux){
-	// struct thread *t_a = list_entry(a, struct thread, elem);
-	// struct thread *t_b = list_entry(b, struct thread, elem);
-	// return (t_a->priority) > (t_b->priority);
-	return (list_entry(a, struct thread, donation_elem)->priority) > (list_entry(b, struct thread, donation_elem)->priority);
+/* Picks the next owner of RW, which must be free: the
+   highest-priority waiting writer if there is one, otherwise every
+   waiting reader. */
+static void
+rwlock_grant(struct rwlock *rw)
+{
+	ASSERT(intr_get_level() == INTR_OFF);
+	ASSERT(rw->writer == NULL && rw->readers == 0);
+
+	if (!heap_empty(&rw->write_waiters))
+	{
+		struct thread *t = heap_entry(heap_pop(&rw->write_waiters), struct thread, wait_elem);
+		struct rwlock_hold *hold = t->wait_on_rwlock;
+
+		t->wait_heap = NULL;
+		t->wait_on_rwlock = NULL;
+		rw->writer = t;
+		rwlock_add_holder(hold);
+		thread_unblock(t);
+	}
+	else
+		while (!heap_empty(&rw->read_waiters))
+		{
+			struct thread *t = heap_entry(heap_pop(&rw->read_waiters), struct thread, wait_elem);
+			struct rwlock_hold *hold = t->wait_on_rwlock;
+
+			t->wait_heap = NULL;
+			t->wait_on_rwlock = NULL;
+			rw->readers++;
+			rwlock_add_holder(hold);
+			thread_unblock(t);
+		}
+}
+
+/* Records that HOLD's thread now holds HOLD's rwlock, and gives it
+   the donations of the threads still waiting for the rwlock. */
+static void
+rwlock_add_holder(struct rwlock_hold *hold)
+{
+	struct thread *t = hold->thread;
+
+	hold->held.max_priority = rwlock_max_waiter_priority(hold->rwlock);
+	list_push_back(&hold->rwlock->holders, &hold->elem);
+	list_push_back(&t->rw_holds, &hold->thread_elem);
+	heap_insert(&t->held_locks, &hold->held.elem);
+
+	if (!thread_mlfqs)
+		donate_chain(t, hold->held.max_priority);
+}
+
+/* Removes the current thread's hold on RW and returns it, for the
+   caller to free once interrupts are back on. */
+static struct rwlock_hold *
+rwlock_remove_holder(struct rwlock *rw)
+{
+	struct thread *curr = thread_current();
+	struct list_elem *e;
+
+	for (e = list_begin(&curr->rw_holds); e != list_end(&curr->rw_holds); e = list_next(e))
+	{
+		struct rwlock_hold *hold = list_entry(e, struct rwlock_hold, thread_elem);
+		if (hold->rwlock == rw)
+		{
+			list_remove(&hold->elem);
+			list_remove(&hold->thread_elem);
+			heap_remove(&curr->held_locks, &hold->held.elem);
+			return hold;
+		}
+	}
+	NOT_REACHED();
+}
+
+/* Returns the highest priority among threads waiting for RW, or
+   PRI_MIN - 1 if there are none. */
+static int
+rwlock_max_waiter_priority(struct rwlock *rw)
+{
+	struct heap *heaps[] = {&rw->read_waiters, &rw->write_waiters};
+	int max = PRI_MIN - 1;
+
+	for (int i = 0; i < 2; i++)
+		if (!heap_empty(heaps[i]))
+		{
+			struct thread *t = heap_entry(heap_top(heaps[i]), struct thread, wait_elem);
+			if (t->priority > max)
+				max = t->priority;
+		}
+	return max;
 }
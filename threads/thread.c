@@ -11,6 +11,7 @@
 #include "threads/palloc.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
+#include "devices/timer.h"
 #include "intrinsic.h"
 #ifdef USERPROG
 #include "userprog/process.h"
@@ -20,9 +21,39 @@
 
 #define THREAD_BASIC 0xd42df210
 
-static struct list ready_list;
+/* Scheduler state of the CPU, including its multi-level run queue.
+   Each priority level has its own FIFO of THREAD_READY threads,
+   so the highest runnable priority is a single find-last-set on
+   ready_bitmap instead of a walk of a sorted list.
 
-static struct thread *idle_thread;
+   Pintos runs on the boot processor only: nothing starts the
+   application processors or programs the local and I/O APICs,
+   and there is no -smp option.  So there is exactly one struct
+   cpu, and it is protected by turning interrupts off.  Running on
+   several CPUs would need all of that bring-up, one struct cpu
+   and run queue per processor, and spinlocks in place of
+   interrupt disabling throughout the kernel. */
+struct cpu
+{
+	struct thread *curr;		/* Running thread. */
+	struct thread *idle_thread; /* Idle thread. */
+
+	/* Run queue.  Bit N of ready_bitmap is set while
+	   ready_queues[N] is non-empty. */
+	struct list ready_queues[PRI_MAX + 1];
+	uint64_t ready_bitmap;
+	int ready_cnt; /* Threads in ready_queues that count toward load_avg. */
+
+	bool preempting; /* curr is being switched out by thread_preempt(). */
+
+	/* Owned by the timer interrupt. */
+	unsigned thread_ticks; /* Ticks since the running thread started its slice. */
+	long long idle_ticks;
+	long long kernel_ticks;
+	long long user_ticks;
+};
+
+static struct cpu cpu;
 
 static struct thread *initial_thread;
 
@@ -30,28 +61,54 @@ static struct lock tid_lock;
 
 static struct list destruction_req;
 
-static long long idle_ticks;
-static long long kernel_ticks;
-static long long user_ticks;
+/* Every live thread, for the scheduler statistics dump. */
+static struct list all_list;
+
+/* Ready-to-running latency of unblocked threads, in TSC cycles.
+   Bucket N counts latencies in [2^N, 2^(N+1)); row 1 only counts
+   threads running above PRI_DEFAULT. */
+#define LATENCY_BUCKETS 64
+static uint64_t latency_hist[2][LATENCY_BUCKETS];
 
 #define TIME_SLICE 4
-static unsigned thread_ticks;
 
 bool thread_mlfqs;
 
+/* Advanced scheduler state.  recent_cpu is only decayed eagerly
+   for the running and ready threads; a blocked thread catches up
+   when it is unblocked, replaying the per-second decay
+   coefficients it missed from decay_history. */
+#define DECAY_HISTORY 64
+static fixed_t load_avg;
+static int64_t mlfqs_seconds; /* Per-second updates done so far. */
+static fixed_t decay_history[DECAY_HISTORY];
+
+static void mlfqs_tick(struct thread *);
+static void mlfqs_second(void);
+static void mlfqs_catch_up(struct thread *);
+static int mlfqs_priority(const struct thread *);
+
 static void kernel_thread(thread_func *, void *aux);
 
 static void idle(void *aux UNUSED);
 static struct thread *next_thread_to_run(void);
+static void record_latency(struct thread *);
 static void init_thread(struct thread *, const char *name, int priority);
 static void do_schedule(int status);
 static void schedule(void);
 static tid_t allocate_tid(void);
-void update_next_to_wake(int64_t local_ticks);
+
+static void cpu_init(struct cpu *);
+static bool is_idle_thread(const struct thread *);
+static void ready_queue_push(struct cpu *, struct thread *);
+static void ready_queue_remove(struct cpu *, struct thread *);
+static struct thread *ready_queue_pop(struct cpu *);
+static int ready_queue_max_priority(const struct cpu *);
 
 /*----------------추가 선언 함수-------------------*/
-static struct list sleep_list;
-static int64_t min_ticks; /*🤔*/
+/* Sleeping threads, ordered by wake_up_tick. */
+static struct heap sleep_heap;
+static heap_less_func wake_up_less;
 
 void thread_wakeup(int64_t ticks);
 void thread_sleep(int64_t ticks);
@@ -76,17 +133,17 @@ void thread_init(void)
 		.address = (uint64_t)gdt};
 	lgdt(&gdt_ds);
 
-	lock_init(&tid_lock);
-	list_init(&ready_list);
-	list_init(&sleep_list);
+	lock_init_named(&tid_lock, "tid");
+	cpu_init(&cpu);
+	heap_init(&sleep_heap, wake_up_less, NULL);
 	list_init(&destruction_req);
-
-	min_ticks = INT64_MAX; /**/
+	list_init(&all_list);
 
 	initial_thread = running_thread();
 	init_thread(initial_thread, "main", PRI_DEFAULT);
 	initial_thread->status = THREAD_RUNNING;
 	initial_thread->tid = allocate_tid();
+	cpu.curr = initial_thread;
 	/* file descriptor init */
 }
 
@@ -103,25 +160,80 @@ void thread_start(void)
 
 void thread_tick(void)
 {
+	struct cpu *c = &cpu;
 	struct thread *t = thread_current();
 
-	if (t == idle_thread)
-		idle_ticks++;
+	if (t == c->idle_thread)
+		c->idle_ticks++;
 #ifdef USERPROG
 	else if (t->pml4 != NULL)
-		user_ticks++;
+		c->user_ticks++;
 #endif
 	else
-		kernel_ticks++;
+		c->kernel_ticks++;
+	t->stats.run_ticks++;
 
-	if (++thread_ticks >= TIME_SLICE)
+	if (thread_mlfqs)
+		mlfqs_tick(t);
+
+	if (++c->thread_ticks >= TIME_SLICE)
 		intr_yield_on_return();
 }
 
 void thread_print_stats(void)
 {
+	struct list_elem *e;
+
 	printf("Thread: %lld idle ticks, %lld kernel ticks, %lld user ticks\n",
-		   idle_ticks, kernel_ticks, user_ticks);
+		   cpu.idle_ticks, cpu.kernel_ticks, cpu.user_ticks);
+
+	for (e = list_begin(&all_list); e != list_end(&all_list); e = list_next(e))
+	{
+		struct thread *t = list_entry(e, struct thread, all_elem);
+		printf("  %3d %-16s %lld run, %lld ready, %lld vol, %lld invol, %lld donations\n",
+			   t->tid, t->name, t->stats.run_ticks, t->stats.ready_ticks,
+			   t->stats.voluntary_switches, t->stats.involuntary_switches,
+			   t->stats.donations);
+	}
+}
+
+/* Prints the ready-to-running latency histogram. */
+void thread_print_latency(void)
+{
+	uint64_t total = 0;
+	int i;
+
+	for (i = 0; i < LATENCY_BUCKETS; i++)
+		total += latency_hist[0][i] + latency_hist[1][i];
+	printf("Latency: %llu wake-ups, ready-to-running in TSC cycles\n", total);
+	for (i = 0; i < LATENCY_BUCKETS; i++)
+		if (latency_hist[0][i] + latency_hist[1][i] != 0)
+			printf("  [2^%d, 2^%d): %llu (%llu above default priority)\n", i, i + 1,
+				   latency_hist[0][i] + latency_hist[1][i], latency_hist[1][i]);
+}
+
+/* Records the time NEXT spent between thread_unblock() and now,
+   when it is about to be switched in. */
+static void
+record_latency(struct thread *next)
+{
+	uint64_t cycles;
+	int bucket;
+
+	if (next->unblock_tsc == 0)
+		return;
+	cycles = rdtsc() - next->unblock_tsc;
+	next->unblock_tsc = 0;
+	bucket = cycles != 0 ? 63 - __builtin_clzll(cycles) : 0;
+	latency_hist[next->priority > PRI_DEFAULT][bucket]++;
+}
+
+/* Copies the running thread's scheduler statistics into STATS. */
+void thread_get_stats(struct schedstat *stats)
+{
+	enum intr_level old_level = intr_disable();
+	*stats = thread_current()->stats;
+	intr_set_level(old_level);
 }
 
 tid_t thread_create(const char *name, int priority,
@@ -138,6 +250,13 @@ tid_t thread_create(const char *name, int priority,
 
 	init_thread(t, name, priority);
 	tid = t->tid = allocate_tid();
+	if (function == idle)
+	{
+		/* Mark it as the idle thread before thread_unblock() sees it,
+		   so that the advanced scheduler leaves it at PRI_MIN. */
+		cpu.idle_thread = t;
+		t->priority = t->init_priority = priority;
+	}
 
 	struct thread *curr = thread_current();
 	list_push_back(&curr->children_list, &t->child_elem);
@@ -201,13 +320,16 @@ void thread_unblock(struct thread *t)
 
 	old_level = intr_disable();
 	ASSERT(t->status == THREAD_BLOCKED);
-	/*-------------------------[project 1-2]-------------------------
-	list_push_back(&ready_list, &t->elem);
-	-------------------------[project 1-2]-------------------------*/
-	list_insert_ordered(&ready_list, &t->elem, &priority_less, NULL);
+	if (thread_mlfqs && !is_idle_thread(t))
+	{
+		mlfqs_catch_up(t);
+		t->priority = mlfqs_priority(t);
+	}
+	ready_queue_push(&cpu, t);
 	t->status = THREAD_READY;
+	t->ready_since = timer_ticks();
+	t->unblock_tsc = rdtsc();
 
-	// 우선순위 정렬에 맞게 readu list에 넣는다.
 	intr_set_level(old_level);
 }
 
@@ -260,19 +382,28 @@ void thread_yield(void)
 	ASSERT(!intr_context());
 
 	old_level = intr_disable();
-	if (curr != idle_thread)
-	{
-		/*-------------------------[project 1-2]-------------------------
-		list_push_back(&ready_list, &curr->elem);
-		-------------------------[project 1-2]-------------------------*/
-		list_insert_ordered(&ready_list, &curr->elem, priority_less, NULL);
-	}
+	if (!is_idle_thread(curr))
+		ready_queue_push(&cpu, curr);
+	curr->ready_since = timer_ticks();
 	do_schedule(THREAD_READY);
 	intr_set_level(old_level);
 }
 
+/* Yields the CPU on behalf of an interrupt handler that called
+   intr_yield_on_return(), counting the switch as a preemption
+   rather than a voluntary yield. */
+void thread_preempt(void)
+{
+	cpu.preempting = true;
+	thread_yield();
+}
+
 void thread_set_priority(int new_priority)
 {
+	/* The advanced scheduler owns all priorities. */
+	if (thread_mlfqs)
+		return;
+
 	thread_current()->init_priority = new_priority;
 
 	refresh_priority();
@@ -284,27 +415,170 @@ int thread_get_priority(void)
 	return thread_current()->priority;
 }
 
-void thread_set_nice(int nice UNUSED)
+void thread_set_nice(int nice)
 {
-	/* TODO: Your implementation goes here */
+	struct thread *curr = thread_current();
+	enum intr_level old_level;
+
+	ASSERT(NICE_MIN <= nice && nice <= NICE_MAX);
+
+	old_level = intr_disable();
+	curr->nice = nice;
+	if (thread_mlfqs)
+		curr->priority = mlfqs_priority(curr);
+	intr_set_level(old_level);
+
+	test_max_priority();
+}
+
+/* Marks the current thread as background work, such as the
+   zeroer.  Background threads do not count toward the -mlfqs
+   load_avg, so work that only uses spare CPU time does not slow
+   the decay of other threads' recent_cpu. */
+void thread_set_background(void)
+{
+	enum intr_level old_level = intr_disable();
+	thread_current()->background = true;
+	intr_set_level(old_level);
 }
 
 int thread_get_nice(void)
 {
-	/* TODO: Your implementation goes here */
-	return 0;
+	return thread_current()->nice;
 }
 
 int thread_get_load_avg(void)
 {
-	/* TODO: Your implementation goes here */
-	return 0;
+	enum intr_level old_level = intr_disable();
+	int load = fp_round(load_avg * 100);
+	intr_set_level(old_level);
+	return load;
 }
 
 int thread_get_recent_cpu(void)
 {
-	/* TODO: Your implementation goes here */
-	return 0;
+	enum intr_level old_level = intr_disable();
+	int recent_cpu = fp_round(thread_current()->recent_cpu * 100);
+	intr_set_level(old_level);
+	return recent_cpu;
+}
+
+/* Returns the 4.4BSD priority of T:
+   PRI_MAX - recent_cpu / 4 - nice * 2, clamped to the valid range. */
+static int
+mlfqs_priority(const struct thread *t)
+{
+	int priority = PRI_MAX - fp_to_int(t->recent_cpu / 4) - t->nice * 2;
+
+	if (priority < PRI_MIN)
+		return PRI_MIN;
+	if (priority > PRI_MAX)
+		return PRI_MAX;
+	return priority;
+}
+
+/* Brings T's recent_cpu up to date with the per-second updates it
+   missed while blocked.  The last DECAY_HISTORY seconds are
+   replayed exactly; anything older is folded in with the oldest
+   remembered coefficient, which load_avg changes too slowly for
+   the difference to matter. */
+static void
+mlfqs_catch_up(struct thread *t)
+{
+	int64_t missed = mlfqs_seconds - t->recent_cpu_epoch;
+	int64_t sec;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	if (missed > DECAY_HISTORY)
+	{
+		fixed_t coef = decay_history[mlfqs_seconds % DECAY_HISTORY];
+		for (sec = missed - DECAY_HISTORY; sec > 0; sec--)
+		{
+			fixed_t next = fp_add_int(fp_mul(coef, t->recent_cpu), t->nice);
+			if (next == t->recent_cpu)
+				break; /* Settled; further seconds change nothing. */
+			t->recent_cpu = next;
+		}
+		missed = DECAY_HISTORY;
+	}
+	for (sec = mlfqs_seconds - missed; sec < mlfqs_seconds; sec++)
+		t->recent_cpu = fp_add_int(fp_mul(decay_history[sec % DECAY_HISTORY],
+										  t->recent_cpu),
+								   t->nice);
+	t->recent_cpu_epoch = mlfqs_seconds;
+}
+
+/* Once-a-second update: recomputes load_avg, then decays the
+   recent_cpu of the running and ready threads and requeues ready
+   threads whose priority changed.  Blocked threads are left to
+   mlfqs_catch_up(). */
+static void
+mlfqs_second(void)
+{
+	int ready = cpu.ready_cnt + (cpu.curr != cpu.idle_thread && !cpu.curr->background);
+	fixed_t twice_load;
+	int pri;
+
+	load_avg = fp_mul(fp_div(fp_from_int(59), fp_from_int(60)), load_avg) + fp_from_int(ready) / 60;
+	twice_load = load_avg * 2;
+	decay_history[mlfqs_seconds % DECAY_HISTORY] = fp_div(twice_load, fp_add_int(twice_load, 1));
+	mlfqs_seconds++;
+
+	if (cpu.curr != cpu.idle_thread)
+		mlfqs_catch_up(cpu.curr);
+
+	/* Walking from the highest level down, a thread that moves
+	   down is met again in its new queue, where it no longer
+	   changes. */
+	for (pri = ready_queue_max_priority(&cpu); pri >= PRI_MIN; pri--)
+	{
+		struct list_elem *e = list_begin(&cpu.ready_queues[pri]);
+		while (e != list_end(&cpu.ready_queues[pri]))
+		{
+			struct thread *t = list_entry(e, struct thread, elem);
+			int new_priority;
+
+			e = list_next(e);
+			mlfqs_catch_up(t);
+			new_priority = mlfqs_priority(t);
+			if (new_priority != t->priority)
+			{
+				ready_queue_remove(&cpu, t);
+				t->priority = new_priority;
+				ready_queue_push(&cpu, t);
+			}
+		}
+	}
+}
+
+/* Per-tick accounting for the advanced scheduler, called from the
+   timer interrupt with the running thread T.  Only the running
+   thread's recent_cpu changes between once-a-second updates, so
+   the every-fourth-tick priority refresh only touches T. */
+static void
+mlfqs_tick(struct thread *t)
+{
+	int64_t now = timer_ticks();
+	bool recompute = now % TIME_SLICE == 0;
+
+	if (!is_idle_thread(t))
+		t->recent_cpu = fp_add_int(t->recent_cpu, 1);
+
+	/* Tickless idle may have skipped over several second
+	   boundaries; replay each of them. */
+	while (mlfqs_seconds < now / TIMER_FREQ)
+	{
+		mlfqs_second();
+		recompute = true;
+	}
+
+	if (recompute && !is_idle_thread(t))
+	{
+		t->priority = mlfqs_priority(t);
+		if (ready_queue_max_priority(&cpu) > t->priority)
+			intr_yield_on_return();
+	}
 }
 
 static void
@@ -312,7 +586,6 @@ idle(void *idle_started_ UNUSED)
 {
 	struct semaphore *idle_started = idle_started_;
 
-	idle_thread = thread_current();
 	sema_up(idle_started);
 
 	for (;;)
@@ -320,10 +593,14 @@ idle(void *idle_started_ UNUSED)
 		intr_disable();
 		thread_block();
 
+		/* Nothing else can run, so let the timer sleep until the
+		   next wake-up time if tickless mode is on. */
+		timer_idle_enter();
 		asm volatile("sti; hlt"
 					 :
 					 :
 					 : "memory");
+		timer_idle_exit();
 	}
 }
 
@@ -340,6 +617,8 @@ kernel_thread(thread_func *function, void *aux)
 static void
 init_thread(struct thread *t, const char *name, int priority)
 {
+	enum intr_level old_level;
+
 	ASSERT(t != NULL);
 	ASSERT(PRI_MIN <= priority && priority <= PRI_MAX);
 	ASSERT(name != NULL);
@@ -353,8 +632,23 @@ init_thread(struct thread *t, const char *name, int priority)
 	/*----------------[project1]-------------------*/
 	t->init_priority = priority;
 	t->wait_on_lock = NULL;
-	list_init(&t->donations);
+	heap_init(&t->held_locks, lock_priority_greater, NULL);
+	list_init(&t->rw_holds);
 	/*----------------[project1]-------------------*/
+	if (t != running_thread())
+	{
+		/* New threads inherit their parent's niceness and CPU usage. */
+		struct thread *parent = running_thread();
+		t->nice = parent->nice;
+		t->recent_cpu = parent->recent_cpu;
+	}
+	t->recent_cpu_epoch = mlfqs_seconds;
+	if (thread_mlfqs)
+		t->priority = t->init_priority = mlfqs_priority(t);
+
+	old_level = intr_disable();
+	list_push_back(&all_list, &t->all_elem);
+	intr_set_level(old_level);
 	list_init(&t->children_list);
 
 	sema_init(&t->wait_sema, 0);
@@ -368,10 +662,103 @@ init_thread(struct thread *t, const char *name, int priority)
 static struct thread *
 next_thread_to_run(void)
 {
-	if (list_empty(&ready_list))
-		return idle_thread;
+	return cpu.ready_bitmap != 0 ? ready_queue_pop(&cpu) : cpu.idle_thread;
+}
+
+static void
+cpu_init(struct cpu *c)
+{
+	int i;
+
+	memset(c, 0, sizeof *c);
+	for (i = PRI_MIN; i <= PRI_MAX; i++)
+		list_init(&c->ready_queues[i]);
+}
+
+/* Returns true if T is the idle thread. */
+static bool
+is_idle_thread(const struct thread *t)
+{
+	return t == cpu.idle_thread;
+}
+
+/* Appends T to C's run queue of T's current priority.
+   Interrupts must be off. */
+static void
+ready_queue_push(struct cpu *c, struct thread *t)
+{
+	ASSERT(intr_get_level() == INTR_OFF);
+	ASSERT(PRI_MIN <= t->priority && t->priority <= PRI_MAX);
+
+	list_push_back(&c->ready_queues[t->priority], &t->elem);
+	c->ready_bitmap |= 1ULL << t->priority;
+	c->ready_cnt += !t->background;
+}
+
+/* Removes T, which must be THREAD_READY, from C's run queue.
+   Interrupts must be off. */
+static void
+ready_queue_remove(struct cpu *c, struct thread *t)
+{
+	ASSERT(intr_get_level() == INTR_OFF);
+	ASSERT(t->status == THREAD_READY);
+
+	list_remove(&t->elem);
+	if (list_empty(&c->ready_queues[t->priority]))
+		c->ready_bitmap &= ~(1ULL << t->priority);
+	c->ready_cnt -= !t->background;
+}
+
+/* Removes and returns the first thread of C's highest non-empty
+   run queue, which must not be empty.  Interrupts must be off. */
+static struct thread *
+ready_queue_pop(struct cpu *c)
+{
+	int priority = ready_queue_max_priority(c);
+	struct thread *t;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+	ASSERT(priority >= PRI_MIN);
+	t = list_entry(list_pop_front(&c->ready_queues[priority]), struct thread, elem);
+	if (list_empty(&c->ready_queues[priority]))
+		c->ready_bitmap &= ~(1ULL << priority);
+	c->ready_cnt -= !t->background;
+	return t;
+}
+
+/* Returns the highest priority among threads ready on C, or
+   PRI_MIN - 1 if none is.  With interrupts on this is only a
+   snapshot. */
+static int
+ready_queue_max_priority(const struct cpu *c)
+{
+	uint64_t bitmap = c->ready_bitmap;
+
+	if (bitmap == 0)
+		return PRI_MIN - 1;
+	return 63 - __builtin_clzll(bitmap);
+}
+
+/* Sets T's effective priority to PRIORITY.  A ready thread is
+   moved to the run queue that matches its new priority, so that
+   priority donation to a runnable holder takes effect at once. */
+void thread_change_priority(struct thread *t, int priority)
+{
+	enum intr_level old_level;
+
+	ASSERT(is_thread(t));
+	ASSERT(PRI_MIN <= priority && priority <= PRI_MAX);
+
+	old_level = intr_disable();
+	if (t->status == THREAD_READY && t->priority != priority)
+	{
+		ready_queue_remove(&cpu, t);
+		t->priority = priority;
+		ready_queue_push(&cpu, t);
+	}
 	else
-		return list_entry(list_pop_front(&ready_list), struct thread, elem);
+		t->priority = priority;
+	intr_set_level(old_level);
 }
 
 void do_iret(struct intr_frame *tf)
@@ -476,15 +863,19 @@ static void do_schedule(int status)
 curr_thread가 running이 아니고 ,ready_list의 head가 정상이고, */
 static void schedule(void)
 {
+	struct cpu *c = &cpu;
 	struct thread *curr = running_thread(); // running Thread
 	struct thread *next = next_thread_to_run();
+	bool preempted = c->preempting;
 
 	ASSERT(intr_get_level() == INTR_OFF);
 	ASSERT(curr->status != THREAD_RUNNING);
 	ASSERT(is_thread(next));
 	next->status = THREAD_RUNNING;
+	c->curr = next;
 
-	thread_ticks = 0;
+	c->thread_ticks = 0;
+	c->preempting = false;
 
 #ifdef USERPROG
 	/* Activate the new address space. */
@@ -493,6 +884,18 @@ static void schedule(void)
 
 	if (curr != next)
 	{
+		if (curr->status == THREAD_READY && preempted)
+			curr->stats.involuntary_switches++;
+		else if (curr->status != THREAD_DYING)
+			curr->stats.voluntary_switches++;
+		if (next != c->idle_thread)
+		{
+			next->stats.ready_ticks += timer_ticks() - next->ready_since;
+			record_latency(next);
+		}
+
+		if (curr->status == THREAD_DYING)
+			list_remove(&curr->all_elem);
 		if (curr && curr->status == THREAD_DYING && curr != initial_thread)
 		{
 			ASSERT(curr != next);
@@ -517,59 +920,58 @@ allocate_tid(void)
 }
 
 /*-------------------------[project 1]-------------------------*/
+/* Puts the current thread to sleep until the timer reaches
+   LOCAL_TICKS.  Sleepers are kept in a min-heap on wake_up_tick,
+   so the timer interrupt only has to look at the top of the
+   heap. */
 void thread_sleep(int64_t local_ticks) /* local_ticks: 깨울 시간 */
 {
 	struct thread *curr = thread_current();
 	enum intr_level old_level;
 
 	ASSERT(!intr_context());
-	ASSERT(curr != idle_thread)
+	ASSERT(!is_idle_thread(curr));
 
 	old_level = intr_disable(); /* 인터럽트 방지 */
 
 	curr->wake_up_tick = local_ticks;
-	update_next_to_wake(local_ticks); /* sleep_list의 min_tick 업데이트 */
-	list_push_back(&sleep_list, &curr->elem);
+	heap_insert(&sleep_heap, &curr->sleep_elem);
 	thread_block();
 
 	intr_set_level(old_level); /* 인터럽트 재개 */
 }
 
+/* Wakes every sleeping thread whose wake-up time is at or before
+   TICKS.  Costs O(log n) per thread woken and nothing for the
+   threads that keep sleeping. */
 void thread_wakeup(int64_t ticks) /* ticks: global ticks */
 {
-	struct list_elem *curr = list_begin(&sleep_list);
-	/* ⚠️ list_front 사용 시 sleep_list가 비어 있을 경우, ASSERT 발생 => list_begin 사용 */
-	while (curr != list_end(&sleep_list)) /* sleep_list 끝까지 탐색 */
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	while (get_next_to_wakeup() <= ticks)
 	{
-		struct thread *t = list_entry(curr, struct thread, elem);
-		int64_t tmp_ticks = t->wake_up_tick;
-		if (tmp_ticks <= ticks) /* 현재 탐색 중인 스레드가 깰 시간이 되었을 때 */
-		{
-			curr = list_remove(&t->elem); /* sleep_list에서 제거 */
-			thread_unblock(t);
-			/*
-			⚠️ thread_unblock을 list_remove보다 먼저 사용 시 ready_list로 이동 => list_remove 시 ready_list에서 제거
-				* 원래 의도: sleep_list에서 제거
-			 */
-		}
-		else /* 깨울 스레드가 아니면 */
-		{
-			curr = list_next(curr);
-			update_next_to_wake(t->wake_up_tick);
-		}
+		struct thread *t = heap_entry(heap_pop(&sleep_heap), struct thread, sleep_elem);
+		thread_unblock(t);
 	}
 }
 
-/* local_ticks와 min_ticks 비교 => 최솟값 업데이트 */
-void update_next_to_wake(int64_t local_ticks)
+/* Returns the earliest wake-up time among sleeping threads, or
+   INT64_MAX if no thread is asleep. */
+int64_t get_next_to_wakeup(void)
 {
-	min_ticks = (local_ticks < min_ticks) ? local_ticks : min_ticks;
+	if (heap_empty(&sleep_heap))
+		return INT64_MAX;
+	return heap_entry(heap_top(&sleep_heap), struct thread, sleep_elem)->wake_up_tick;
 }
 
-int64_t get_next_to_wakeup(void)
+/* Orders sleeping threads by wake-up time. */
+static bool
+wake_up_less(const struct heap_elem *a_, const struct heap_elem *b_,
+			 void *aux UNUSED)
 {
-	return min_ticks;
-	/* ⚠️ 이후 재새용성을 위한 함수 */
+	const struct thread *a = heap_entry(a_, struct thread, sleep_elem);
+	const struct thread *b = heap_entry(b_, struct thread, sleep_elem);
+	return a->wake_up_tick < b->wake_up_tick;
 }
 
 bool priority_less(const struct list_elem *a, const struct list_elem *b,
@@ -582,14 +984,11 @@ bool priority_less(const struct list_elem *a, const struct list_elem *b,
 
 void test_max_priority(void)
 {
-	if (list_empty(&ready_list) || intr_context())
+	if (intr_context())
 	{
 		return;
 	}
-	int run_priority = thread_current()->priority;
-	struct list_elem *e = list_begin(&ready_list);
-	struct thread *t = list_entry(e, struct thread, elem);
-	if (t->priority > thread_get_priority())
+	if (ready_queue_max_priority(&cpu) > thread_get_priority())
 	{
 		thread_yield();
 	}
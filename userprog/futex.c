@@ -0,0 +1,186 @@
+#include "userprog/futex.h"
+#include <debug.h>
+#include <list.h>
+#include <stdint.h>
+#include "lib/kernel/hash.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+
+/* Fast user-space mutexes.
+ *
+ * A user program keeps the state of its lock in an ordinary int
+ * and only enters the kernel when it has to block (futex_wait)
+ * or when somebody may be blocked (futex_wake).  The kernel side
+ * is just a set of wait queues, one per int that currently has
+ * waiters.
+ *
+ * Queues are keyed on the address space and the user virtual
+ * address of the int.  Keying on the frame instead would break as
+ * soon as the page is evicted, swapped back in elsewhere, or
+ * copied on a write to a copy-on-write page, and Pintos has no
+ * memory shared between processes that would need it.  A queue is
+ * created by its first waiter and freed when the last one is
+ * woken.
+ *
+ * The int is read through its user address, so a page that is
+ * not present is faulted in like any other user access.
+ *
+ * futex_lock serializes the check of the int's value against the
+ * queueing of the waiter, so a wake that follows a store to the
+ * int cannot slip in between them and be lost.  The waiter blocks
+ * only after dropping futex_lock; a wakeup in that window just
+ * leaves its semaphore up, and sema_down() returns at once. */
+
+/* Wait queue for one int. */
+struct futex_queue
+  {
+    struct hash_elem elem;      /* Element in futex_queues. */
+    const void *as;             /* Address space (page map level 4). */
+    const int *uaddr;           /* User virtual address of the int. */
+    struct list waiters;        /* Blocked futex_waiters, by priority. */
+  };
+
+/* A thread blocked in futex_sleep(). */
+struct futex_waiter
+  {
+    struct list_elem elem;      /* Element in futex_queue's waiters. */
+    struct semaphore sema;      /* Upped to wake the thread. */
+    int priority;               /* Priority when it went to sleep. */
+  };
+
+static struct hash futex_queues;
+static struct lock futex_lock;
+
+static hash_hash_func futex_hash;
+static hash_less_func futex_less;
+static struct futex_queue *futex_find (const int *uaddr);
+static bool waiter_priority_more (const struct list_elem *,
+                                  const struct list_elem *, void *aux);
+
+/* Initializes the futex wait queues. */
+void
+futex_init (void) 
+{
+  hash_init (&futex_queues, futex_hash, futex_less, NULL);
+  lock_init_named (&futex_lock, "futex");
+}
+
+/* If the int at user virtual address UADDR in the current process
+   still holds VAL, blocks until futex_wakeup() is called on it and
+   returns true.  Otherwise returns false right away.  UADDR must be
+   a valid user address, aligned on an int. */
+bool
+futex_sleep (const int *uaddr, int val) 
+{
+  struct futex_waiter waiter;
+  struct futex_queue *q;
+
+  ASSERT (is_user_vaddr (uaddr));
+  ASSERT (((uintptr_t) uaddr & (sizeof *uaddr - 1)) == 0);
+
+  lock_acquire (&futex_lock);
+  if (*(volatile const int *) uaddr != val) 
+    {
+      lock_release (&futex_lock);
+      return false;
+    }
+
+  q = futex_find (uaddr);
+  if (q == NULL) 
+    {
+      q = malloc (sizeof *q);
+      if (q == NULL) 
+        {
+          /* Behave like a spurious wakeup; the caller retries. */
+          lock_release (&futex_lock);
+          return true;
+        }
+      q->as = thread_current ()->pml4;
+      q->uaddr = uaddr;
+      list_init (&q->waiters);
+      hash_insert (&futex_queues, &q->elem);
+    }
+
+  sema_init (&waiter.sema, 0);
+  waiter.priority = thread_get_priority ();
+  list_insert_ordered (&q->waiters, &waiter.elem, waiter_priority_more, NULL);
+  lock_release (&futex_lock);
+
+  sema_down (&waiter.sema);
+  return true;
+}
+
+/* Wakes up to CNT threads sleeping on the int at user virtual
+   address UADDR in the current process, highest priority first,
+   and returns how many were woken. */
+int
+futex_wakeup (const int *uaddr, int cnt) 
+{
+  struct futex_queue *q;
+  int woken = 0;
+
+  lock_acquire (&futex_lock);
+  q = futex_find (uaddr);
+  if (q != NULL) 
+    {
+      while (woken < cnt && !list_empty (&q->waiters)) 
+        {
+          struct futex_waiter *w = list_entry (list_pop_front (&q->waiters),
+                                               struct futex_waiter, elem);
+          sema_up (&w->sema);
+          woken++;
+        }
+      if (list_empty (&q->waiters)) 
+        {
+          hash_delete (&futex_queues, &q->elem);
+          free (q);
+        }
+    }
+  lock_release (&futex_lock);
+
+  return woken;
+}
+
+/* Returns the current process's wait queue for UADDR, or a null
+   pointer if nobody waits on it. */
+static struct futex_queue *
+futex_find (const int *uaddr) 
+{
+  struct futex_queue key;
+  struct hash_elem *e;
+
+  key.as = thread_current ()->pml4;
+  key.uaddr = uaddr;
+  e = hash_find (&futex_queues, &key.elem);
+  return e != NULL ? hash_entry (e, struct futex_queue, elem) : NULL;
+}
+
+static uint64_t
+futex_hash (const struct hash_elem *e, void *aux UNUSED) 
+{
+  const struct futex_queue *q = hash_entry (e, struct futex_queue, elem);
+  return hash_bytes (&q->uaddr, sizeof q->uaddr)
+         ^ hash_bytes (&q->as, sizeof q->as);
+}
+
+static bool
+futex_less (const struct hash_elem *a, const struct hash_elem *b,
+            void *aux UNUSED) 
+{
+  const struct futex_queue *qa = hash_entry (a, struct futex_queue, elem);
+  const struct futex_queue *qb = hash_entry (b, struct futex_queue, elem);
+
+  if (qa->as != qb->as)
+    return (uintptr_t) qa->as < (uintptr_t) qb->as;
+  return (uintptr_t) qa->uaddr < (uintptr_t) qb->uaddr;
+}
+
+static bool
+waiter_priority_more (const struct list_elem *a, const struct list_elem *b,
+                      void *aux UNUSED) 
+{
+  return list_entry (a, struct futex_waiter, elem)->priority
+         > list_entry (b, struct futex_waiter, elem)->priority;
+}
@@ -1,5 +1,6 @@
 #include "userprog/syscall.h"
 #include <stdio.h>
+#include <string.h>
 #include <syscall-nr.h>
 #include "threads/interrupt.h"
 #include "threads/thread.h"
@@ -12,6 +13,7 @@
 #include "userprog/process.h"
 #include "devices/input.h"
 #include "threads/palloc.h"
+#include "userprog/futex.h"
 
 void syscall_entry(void);
 void syscall_handler(struct intr_frame *);
@@ -31,6 +33,9 @@ void close(int fd);
 tid_t fork(const char *thread_name, struct intr_frame *f);
 int wait(tid_t pid);
 unsigned tell(int fd);
+void schedstat(struct schedstat *stats);
+int futex_wait(int *addr, int val);
+int futex_wake(int *addr, int cnt);
 
 struct file *process_get_file(int fd);
 void process_close_file(int fd);
@@ -67,8 +72,9 @@ void syscall_init(void)
 			  FLAG_IF | FLAG_TF | FLAG_DF | FLAG_IOPL | FLAG_AC | FLAG_NT);
 
 	/* project2 */
-	lock_init(&filesys_lock);
+	lock_init_named(&filesys_lock, "filesys");
 	/* project2 */
+	futex_init();
 }
 
 /* The main system call interface */
@@ -121,6 +127,15 @@ void syscall_handler(struct intr_frame *f)
 	case SYS_CLOSE:
 		close(f->R.rdi);
 		break;
+	case SYS_SCHEDSTAT:
+		schedstat(f->R.rdi);
+		break;
+	case SYS_FUTEX_WAIT:
+		f->R.rax = futex_wait(f->R.rdi, f->R.rsi);
+		break;
+	case SYS_FUTEX_WAKE:
+		f->R.rax = futex_wake(f->R.rdi, f->R.rsi);
+		break;
 	// case SYS_DUP2:
 	// 	dup2(f->R.rdi, f->R.rsi);
 	// 	break;
@@ -160,12 +175,12 @@ void syscall_handler(struct intr_frame *f)
 	}
 }
 
-/* 입력된 주소가 유효한 주소인지 확인하고, 그렇지 않으면 프로세스를 종료시키는 함수 */
+/* 입력된 주소가 유효한 주소인지 확인하고, 그렇지 않으면 프로세스를 종료시키는 함수.
+ * present 여부가 아니라 SPT로 판단한다. 스왑아웃된 페이지도 유효한 주소이며,
+ * 커널이 접근할 때 vm_try_handle_fault가 다시 올려준다. */
 struct page *check_address(const void *addr)
 {
-	struct thread *curr = thread_current();
-
-	if (is_kernel_vaddr(addr) || addr == NULL || pml4_get_page(curr->pml4, addr) == NULL)
+	if (is_kernel_vaddr(addr) || addr == NULL)
 	{
 		exit(-1);
 	} else {
@@ -413,6 +428,41 @@ int wait(tid_t pid)
 	return process_wait(pid);
 }
 
+/* 현재 스레드의 스케줄러 통계를 사용자 버퍼에 복사하는 시스템콜 함수 */
+void schedstat(struct schedstat *stats)
+{
+	struct schedstat snapshot;
+
+	/* 읽기 전용 버퍼에 쓰면 커널 모드에서 폴트가 나므로 미리 막는다. */
+	if (!check_address(stats)->writable ||
+		!check_address((char *)stats + sizeof *stats - 1)->writable)
+		exit(-1);
+
+	thread_get_stats(&snapshot);
+	memcpy(stats, &snapshot, sizeof snapshot);
+}
+
+/* 사용자 주소 ADDR 의 int 가 아직 VAL 이면 futex_wake() 될 때까지 잠드는 시스템콜 함수.
+   이미 값이 바뀌었으면 바로 -1 을 반환한다. */
+int futex_wait(int *addr, int val)
+{
+	check_address(addr);
+	if ((uintptr_t)addr % sizeof *addr != 0)
+		return -1;
+
+	return futex_sleep(addr, val) ? 0 : -1;
+}
+
+/* 사용자 주소 ADDR 의 int 에서 잠든 스레드를 최대 CNT 개 깨우는 시스템콜 함수 */
+int futex_wake(int *addr, int cnt)
+{
+	check_address(addr);
+	if ((uintptr_t)addr % sizeof *addr != 0)
+		return -1;
+
+	return futex_wakeup(addr, cnt);
+}
+
 /*  현재 스레드의 fdt에 주어진 파일을 추가하고, 추가된 파일의 식별자를 반환하는 함수*/
 int process_add_file(struct file *f)
 {
@@ -1,7 +1,14 @@
 /* anon.c: Implementation of page for non-disk image (a.k.a. anonymous page). */
 
 #include "vm/vm.h"
+#include <bitmap.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
 #include "devices/disk.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
 
 /* DO NOT MODIFY BELOW LINE */
 static struct disk *swap_disk;
@@ -9,6 +16,27 @@ static bool anon_swap_in (struct page *page, void *kva);
 static bool anon_swap_out (struct page *page);
 static void anon_destroy (struct page *page);
 
+/* 페이지 하나가 차지하는 섹터 수. swap disk 는 이 크기의 slot 으로 나눠 쓴다. */
+#define SECTORS_PER_PAGE (PGSIZE / DISK_SECTOR_SIZE)
+
+/* swap slot 사용 여부. 비트 하나가 slot 하나(연속된 8 섹터)이다.
+ * swap_lock 으로 보호한다. */
+static struct bitmap *swap_table;
+static struct lock swap_lock;
+
+/* slot 마다 그 slot 을 가리키는 페이지 수. fork 로 공유하던 frame 을
+ * 쫓아내면 공유하던 페이지들이 slot 하나를 함께 쓴다. swap_lock 으로
+ * 보호한다. */
+static uint16_t *swap_refs;
+
+/* 통계. swap_lock 으로 보호한다. */
+static unsigned long long swap_in_cnt;
+static unsigned long long swap_out_cnt;
+static unsigned long long read_ahead_cnt;	/* 미리 읽은 페이지. */
+static unsigned long long read_ahead_hit_cnt;	/* 그 중 실제로 쓰인 페이지. */
+
+static void swap_slot_free (int swap_sector);
+
 /* DO NOT MODIFY this struct */
 static const struct page_operations anon_ops = {
 	.swap_in = anon_swap_in,
@@ -21,10 +49,15 @@ static const struct page_operations anon_ops = {
 void
 vm_anon_init (void) {
 	/* TODO: Set up the swap_disk. */
-	swap_disk = NULL;
+	swap_disk = disk_get(1, 1);
+	size_t slot_cnt = swap_disk != NULL
+			? disk_size(swap_disk) / SECTORS_PER_PAGE : 0;
 
-
-	
+	lock_init(&swap_lock);
+	swap_table = bitmap_create(slot_cnt);
+	swap_refs = calloc(slot_cnt, sizeof *swap_refs);
+	if (swap_table == NULL || (slot_cnt > 0 && swap_refs == NULL))
+		PANIC("swap table creation failed");
 }
 
 /* Initialize the file mapping */
@@ -41,24 +74,148 @@ anon_initializer (struct page *page, enum vm_type type, void *kva) {
 
 	struct anon_page *anon_page = &page->anon;
 	anon_page->swap_sector = -1;
+	anon_page->read_ahead = false;
 	
 	return true;
 }
 
 /* Swap in the page by read contents from the swap disk. */
+/* swap slot 의 8 섹터를 한 번에 읽어 오고 slot 을 돌려준다. */
 static bool
 anon_swap_in (struct page *page, void *kva) {
 	struct anon_page *anon_page = &page->anon;
+	bool read_ahead = anon_page->read_ahead;
+
+	if (anon_page->swap_sector < 0)
+		return false;
+
+	/* 미리 읽어 둔 페이지는 이미 KVA 에 내용이 있다. */
+	if (!read_ahead)
+		disk_read_multiple(swap_disk, anon_page->swap_sector, kva,
+				SECTORS_PER_PAGE);
+	swap_slot_free(anon_page->swap_sector);
+	anon_page->swap_sector = -1;
+	anon_page->read_ahead = false;
+
+	lock_acquire(&swap_lock);
+	if (read_ahead)
+		read_ahead_hit_cnt++;
+	else
+		swap_in_cnt++;
+	lock_release(&swap_lock);
+	return true;
+}
+
+/* swap 에 나가 있는 anonymous 페이지이면 true. */
+bool
+anon_is_swapped_out (struct page *page) {
+	return page->operations->type == VM_ANON && page->anon.swap_sector >= 0
+		&& !page->anon.read_ahead;
+}
+
+/* swap 에 나가 있는 PAGE 의 내용을 KVA 로 미리 읽어 둔다. 페이지가 실제로
+ * 매핑될 때까지 slot 은 그대로 두므로, 쓰이지 않고 쫓겨나면 다시 쓸
+ * 필요 없이 frame 만 버리면 된다. */
+void
+anon_read_ahead (struct page *page, void *kva) {
+	struct anon_page *anon_page = &page->anon;
+
+	ASSERT(anon_is_swapped_out(page));
+
+	disk_read_multiple(swap_disk, anon_page->swap_sector, kva,
+			SECTORS_PER_PAGE);
+	anon_page->read_ahead = true;
+
+	lock_acquire(&swap_lock);
+	read_ahead_cnt++;
+	lock_release(&swap_lock);
 }
 
 /* Swap out the page by writing contents to the swap disk. */
+/* 빈 slot 을 하나 잡아 페이지를 한 번에 쓴다. 빈 slot 이 없으면 false. */
 static bool
 anon_swap_out (struct page *page) {
 	struct anon_page *anon_page = &page->anon;
+	size_t slot;
+
+	/* 미리 읽었지만 쓰이지 않은 페이지는 slot 에 내용이 그대로 있다. */
+	if (anon_page->read_ahead)
+	{
+		anon_page->read_ahead = false;
+		return true;
+	}
+
+	lock_acquire(&swap_lock);
+	slot = bitmap_scan_and_flip(swap_table, 0, 1, false);
+	if (slot != BITMAP_ERROR)
+	{
+		swap_refs[slot] = 1;
+		swap_out_cnt++;
+	}
+	lock_release(&swap_lock);
+	if (slot == BITMAP_ERROR)
+		return false;
+
+	anon_page->swap_sector = slot * SECTORS_PER_PAGE;
+	disk_write_multiple(swap_disk, anon_page->swap_sector,
+			page->frame->kva, SECTORS_PER_PAGE);
+	return true;
 }
 
 /* Destroy the anonymous page. PAGE will be freed by the caller. */
 static void
 anon_destroy (struct page *page) {
 	struct anon_page *anon_page = &page->anon;
+
+	/* 쫓겨난 채로 해제되는 페이지는 slot 만 돌려주면 된다. */
+	if (anon_page->swap_sector >= 0)
+		swap_slot_free(anon_page->swap_sector);
+	anon_page->swap_sector = -1;
+	anon_page->read_ahead = false;
+}
+
+/* SRC 와 frame 을 공유하던 DST 가 SRC 와 같은 swap slot 을 가리키게 한다.
+ * SRC 는 방금 swap_out 되었어야 한다. */
+void
+anon_share_slot (struct page *dst, struct page *src) {
+	int swap_sector = src->anon.swap_sector;
+
+	ASSERT(src->operations == &anon_ops && dst->operations == &anon_ops);
+	ASSERT(swap_sector >= 0);
+	ASSERT(dst->anon.swap_sector < 0);
+
+	lock_acquire(&swap_lock);
+	ASSERT(swap_refs[swap_sector / SECTORS_PER_PAGE] < UINT16_MAX);
+	swap_refs[swap_sector / SECTORS_PER_PAGE]++;
+	lock_release(&swap_lock);
+	dst->anon.swap_sector = swap_sector;
+	dst->anon.read_ahead = false;
+}
+
+/* SWAP_SECTOR 에서 시작하는 swap slot 의 참조를 하나 놓는다. 더 가리키는
+ * 페이지가 없으면 빈 slot 으로 되돌린다. */
+static void
+swap_slot_free (int swap_sector) {
+	size_t slot = swap_sector / SECTORS_PER_PAGE;
+
+	lock_acquire(&swap_lock);
+	ASSERT(bitmap_test(swap_table, slot));
+	ASSERT(swap_refs[slot] > 0);
+	if (--swap_refs[slot] == 0)
+		bitmap_reset(swap_table, slot);
+	lock_release(&swap_lock);
+}
+
+/* Prints swap statistics. */
+void
+swap_print_stats (void) {
+	if (swap_disk == NULL)
+		return;
+	lock_acquire(&swap_lock);
+	printf("Swap: %llu pages in, %llu pages out, "
+			"%llu read ahead (%llu used), %zu of %zu slots in use\n",
+			swap_in_cnt, swap_out_cnt, read_ahead_cnt, read_ahead_hit_cnt,
+			bitmap_count(swap_table, 0, bitmap_size(swap_table), true),
+			bitmap_size(swap_table));
+	lock_release(&swap_lock);
 }
@@ -1,15 +1,57 @@
 /* vm.c: Generic interface for virtual memory objects. */
 
 #include "threads/malloc.h"
+#include "threads/slab.h"
 #include "vm/vm.h"
 #include "vm/inspect.h"
 #include "lib/kernel/hash.h"
 #include "threads/vaddr.h"
 #include "threads/mmu.h"
+#include "devices/timer.h"
 #include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
 #include "userprog/process.h"
 
 /*----------------[project3]-------------------*/
+/* struct page 와 struct frame 은 페이지 하나마다 생기므로 slab 에서 할당한다. */
+static struct kmem_cache page_cache;
+static struct kmem_cache frame_cache;
+
+/* 전역 frame table. 사용자 페이지를 담은 모든 frame 이 lru 에 들어 있고,
+ * 시계 바늘(clock_hand)이 그 위를 돌면서 쫓아낼 frame 을 고른다. */
+struct list lru;
+struct lock lru_lock;
+struct lock kill_lock;
+
+/* 다음에 살펴볼 frame. lru_lock 으로 보호한다. */
+static struct list_elem *clock_hand;
+
+/* 쫓겨나는 중인 frame 의 swap_out 이 끝나면 broadcast 한다. lru_lock 과 함께
+ * 쓴다. */
+static struct condition evict_cond;
+
+/* 쫓아낼 frame 을 고르는 방법. 부팅할 때 -o evict=clock|wsclock 으로 정한다. */
+enum evict_policy
+{
+	EVICT_CLOCK,   /* accessed bit 만 보는 clock. */
+	EVICT_WSCLOCK, /* 마지막 사용 시각과 dirty 여부까지 보는 WSClock. */
+};
+static enum evict_policy evict_policy = EVICT_CLOCK;
+
+/* WSClock 에서 이 tick 수 동안 쓰이지 않은 frame 은 working set 밖으로 본다. */
+#define WS_TAU (TIMER_FREQ / 2)
+
+/* 통계. vm_print_stats() 가 출력한다. */
+static unsigned long long fault_cnt;		 /* 처리한 not-present 폴트 수. */
+static unsigned long long evict_cnt;		 /* 쫓아낸 frame 수. */
+static unsigned long long evict_write_cnt; /* 그 중 디스크에 써야 했던 수. */
+static unsigned long long cow_copy_cnt;	 /* 쓰기 폴트로 공유를 깨고 복사한 수. */
+
+/* swap 에서 페이지를 읽어 올 때 함께 읽어 볼 이웃의 범위(페이지 수).
+ * 폴트가 난 페이지를 포함하는, 이 크기로 정렬된 가상 주소 구간을 본다. */
+#define READ_AROUND_PAGES 8
+
 static unsigned vm_hash_func(const struct hash_elem *e, void *aux);
 static bool vm_less_func(const struct hash_elem *a, const struct hash_elem *b);
 static void spt_destroy_func(struct hash_elem *e, void *aux);
@@ -19,6 +61,13 @@ static void spt_destroy_func(struct hash_elem *e, void *aux);
  * intialize codes. */
 void vm_init(void)
 {
+	kmem_cache_init(&page_cache, "page", sizeof(struct page), 0, NULL);
+	kmem_cache_init(&frame_cache, "frame", sizeof(struct frame), 0, NULL);
+	list_init(&lru);
+	lock_init(&lru_lock);
+	lock_init(&kill_lock);
+	cond_init(&evict_cond);
+	clock_hand = NULL;
 	vm_anon_init();
 	vm_file_init();
 #ifdef EFILESYS /* For project 4 */
@@ -29,6 +78,28 @@ void vm_init(void)
 	/* TODO: Your code goes here. */
 }
 
+/* Selects the eviction policy by NAME, "clock" or "wsclock".
+ * Returns false if NAME is not a known policy. */
+bool vm_set_evict_policy(const char *name)
+{
+	if (!strcmp(name, "clock"))
+		evict_policy = EVICT_CLOCK;
+	else if (!strcmp(name, "wsclock"))
+		evict_policy = EVICT_WSCLOCK;
+	else
+		return false;
+	return true;
+}
+
+/* Prints page fault and eviction statistics. */
+void vm_print_stats(void)
+{
+	printf("VM: %s eviction, %llu faults, %llu evictions (%llu written back), "
+		   "%llu copy-on-write copies\n",
+		   evict_policy == EVICT_WSCLOCK ? "wsclock" : "clock",
+		   fault_cnt, evict_cnt, evict_write_cnt, cow_copy_cnt);
+}
+
 /* Get the type of the page. This function is useful if you want to know the
  * type of the page after it will be initialized.
  * This function is fully implemented now. */
@@ -49,6 +120,8 @@ page_get_type(struct page *page)
 static struct frame *vm_get_victim(void);
 static bool vm_do_claim_page(struct page *page);
 static struct frame *vm_evict_frame(void);
+static void vm_read_around(struct page *page);
+static bool frame_test_and_clear_accessed(struct frame *frame);
 void spt_dealloc(struct hash_elem *e, void *aux);
 
 /* Create the pending page object with initializer. If you want to create a
@@ -69,7 +142,9 @@ bool vm_alloc_page_with_initializer(enum vm_type type, void *upage, bool writabl
 		/* TODO: Create the page, fetch the initialier according to the VM type,
 		 * TODO: and then create "uninit" page struct by calling uninit_new. You
 		 * TODO: should modify the field after calling the uninit_new. */
-		struct page *new_page = palloc_get_page(PAL_ZERO);
+		struct page *new_page = kmem_cache_alloc(&page_cache);
+		if (new_page == NULL)
+			goto err;
 		switch (VM_TYPE(type))
 		{
 		case VM_ANON:
@@ -79,6 +154,7 @@ bool vm_alloc_page_with_initializer(enum vm_type type, void *upage, bool writabl
 			uninit_new(new_page, upage, init, type, aux, file_backed_initializer);
 			break;
 		default:
+			kmem_cache_free(&page_cache, new_page);
 			goto err;
 		}
 		new_page->writable = writable;
@@ -104,13 +180,12 @@ struct page *
 spt_find_page(struct supplemental_page_table *spt UNUSED, void *va UNUSED)
 { /*----------------[project3]-------------------*/
 
-	struct page *page = NULL;
+	struct page page;
 	/* pg_round_down()으로 vaddr의 페이지 번호를 얻음 */
-	uint64_t va_page_num = pg_round_down(va);
 	/* Create a temporary vm_entry to use for searching */
-	page->va = va_page_num;
+	page.va = pg_round_down(va);
 	/* Prepare a hash_elem for the search */
-	struct hash_elem *temp_hash_elem = hash_find(&spt->hash_table, &(page->hash_elem));
+	struct hash_elem *temp_hash_elem = hash_find(&spt->hash_table, &page.hash_elem);
 	/* Check if the element was found */
 	/* 만약 존재하지 않는다면 NULL 리턴 */
 	if (temp_hash_elem == NULL)
@@ -135,40 +210,280 @@ void spt_remove_page(struct supplemental_page_table *spt, struct page *page)
 {
 	pml4_clear_page(thread_current()->pml4, page->va);
 	hash_delete(&spt->hash_table, &page->hash_elem);
-
-	if (page->frame != NULL)
-	{
-		page->frame->page = NULL;
-	}
 	vm_dealloc_page(page);
 	// hash_delete(spt, &page->hash_elem);
 	return true;
 }
 
+/* Clock (second chance) 알고리즘으로 쫓아낼 frame 을 고른다.
+ * 시계 바늘이 가리키는 frame 의 accessed bit 이 켜져 있으면 끄고 넘어가고,
+ * 꺼져 있으면 그 frame 을 고른다. 한 바퀴를 돌면 모든 bit 이 꺼지므로
+ * 늦어도 두 바퀴 안에 끝난다. lru_lock 을 잡고 불러야 한다. */
+static struct frame *
+clock_get_victim(void)
+{
+	size_t n = 2 * list_size(&lru);
+
+	while (n-- > 0)
+	{
+		if (clock_hand == NULL || clock_hand == list_end(&lru))
+			clock_hand = list_begin(&lru);
+
+		struct frame *frame = list_entry(clock_hand, struct frame, lru_elem);
+
+		clock_hand = list_next(clock_hand);
+		if (!frame_test_and_clear_accessed(frame))
+			return frame;
+	}
+	return NULL;
+}
+
+/* FRAME 의 내용을 디스크에 쓰지 않고 버릴 수 있으면 true. 깨끗한 file-backed
+ * 페이지는 파일에서 다시 읽으면 되고, 미리 읽어 두기만 한 anon 페이지는
+ * swap slot 이 아직 남아 있다. */
+static bool
+frame_is_clean(struct frame *frame)
+{
+	struct page *page = frame->page;
+
+	switch (page_get_type(page))
+	{
+	case VM_FILE:
+		return !pml4_is_dirty(page->t->pml4, page->va);
+	case VM_ANON:
+		return page->anon.read_ahead;
+	default:
+		return false;
+	}
+}
+
+/* WSClock 으로 희생 frame 을 고른다. 바늘이 지난 뒤 참조된 frame 은 현재
+ * tick 을 기록하고 넘어간다. WS_TAU 보다 오래 쓰이지 않은 frame 은 working
+ * set 에서 빠진 것으로 보고, 쓰지 않고 버릴 수 있으면 바로 고른다. dirty 한
+ * frame 은 첫 번째 것만 기억해 두고 깨끗한 frame 을 계속 찾는다. 한 바퀴를
+ * 돌아도 working set 밖의 frame 이 없으면 가장 오래전에 쓰인 frame 을 고른다. */
+static struct frame *
+wsclock_get_victim(void)
+{
+	int64_t now = timer_ticks();
+	struct frame *dirty = NULL, *oldest = NULL;
+	size_t n = list_size(&lru);
+
+	while (n-- > 0)
+	{
+		if (clock_hand == NULL || clock_hand == list_end(&lru))
+			clock_hand = list_begin(&lru);
+
+		struct frame *frame = list_entry(clock_hand, struct frame, lru_elem);
+
+		clock_hand = list_next(clock_hand);
+		if (frame_test_and_clear_accessed(frame))
+			frame->last_use = now;
+		else if (now - frame->last_use > WS_TAU)
+		{
+			if (frame_is_clean(frame))
+				return frame;
+			if (dirty == NULL)
+				dirty = frame;
+		}
+		if (oldest == NULL || frame->last_use < oldest->last_use)
+			oldest = frame;
+	}
+	return dirty != NULL ? dirty : oldest;
+}
+
 /* Get the struct frame, that will be evicted. */
+/* 현재 정책으로 희생 frame 을 고른다. lru_lock 을 잡고 불러야 한다. */
 static struct frame *
 vm_get_victim(void)
 {
-	struct frame *victim = NULL;
-	/* TODO: The policy for eviction is up to you. */
-	return victim;
+	ASSERT(lock_held_by_current_thread(&lru_lock));
+
+	if (list_empty(&lru))
+		return NULL;
+	return evict_policy == EVICT_WSCLOCK ? wsclock_get_victim()
+										 : clock_get_victim();
+}
+
+/* Puts FRAME on the frame table as just used.  lru_lock must be held. */
+static void
+frame_table_push(struct frame *frame)
+{
+	frame->last_use = timer_ticks();
+	list_push_back(&lru, &frame->lru_elem);
+}
+
+/* Makes FRAME the frame of PAGE alone. */
+static void
+frame_init(struct frame *frame, struct page *page)
+{
+	frame->page = page;
+	frame->ref_cnt = 1;
+	list_init(&frame->sharers);
+	frame->evicting = false;
+	page->frame = frame;
+}
+
+/* PAGE 의 frame 이 쫓겨나는 중이면 swap_out 이 끝날 때까지 기다린다.
+ * 돌아오면 PAGE 는 frame 을 그대로 가지고 있거나 (쫓아내지 못한 경우)
+ * frame 이 없다. lru_lock 을 잡고 불러야 한다. */
+static void
+frame_wait_evicted(struct page *page)
+{
+	ASSERT(lock_held_by_current_thread(&lru_lock));
+
+	while (page->frame != NULL && page->frame->evicting)
+		cond_wait(&evict_cond, &lru_lock);
+}
+
+/* 공유 중인 FRAME 에서 PAGE 를 뗀다. PAGE 가 대표(frame->page)였으면 남은
+ * 페이지 중 하나가 대표가 된다. lru_lock 을 잡고 불러야 한다. */
+static void
+frame_unshare(struct frame *frame, struct page *page)
+{
+	ASSERT(frame->ref_cnt > 1);
+
+	if (frame->page == page)
+		frame->page = list_entry(list_pop_front(&frame->sharers),
+								 struct page, share_elem);
+	else
+		list_remove(&page->share_elem);
+	frame->ref_cnt--;
+	page->frame = NULL;
+}
+
+/* FRAME 을 매핑한 모든 페이지의 accessed bit 을 끈다. 그 중 하나라도 켜져
+ * 있었으면 true. lru_lock 을 잡고 불러야 한다. */
+static bool
+frame_test_and_clear_accessed(struct frame *frame)
+{
+	struct page *page = frame->page;
+	bool accessed = pml4_is_accessed(page->t->pml4, page->va);
+	struct list_elem *e;
+
+	pml4_set_accessed(page->t->pml4, page->va, false);
+	for (e = list_begin(&frame->sharers); e != list_end(&frame->sharers);
+		 e = list_next(e))
+	{
+		page = list_entry(e, struct page, share_elem);
+		if (pml4_is_accessed(page->t->pml4, page->va))
+		{
+			pml4_set_accessed(page->t->pml4, page->va, false);
+			accessed = true;
+		}
+	}
+	return accessed;
+}
+
+/* FRAME 을 매핑한 모든 페이지의 매핑을 지운다. lru_lock 을 잡고 불러야
+ * 한다. */
+static void
+frame_unmap_all(struct frame *frame)
+{
+	struct list_elem *e;
+
+	pml4_clear_page(frame->page->t->pml4, frame->page->va);
+	for (e = list_begin(&frame->sharers); e != list_end(&frame->sharers);
+		 e = list_next(e))
+	{
+		struct page *page = list_entry(e, struct page, share_elem);
+		pml4_clear_page(page->t->pml4, page->va);
+	}
+}
+
+/* frame_unmap_all() 로 내렸던 FRAME 을 다시 매핑한다. 공유 중이면 모두
+ * 읽기 전용으로 매핑한다. lru_lock 을 잡고 불러야 한다. */
+static void
+frame_map_all(struct frame *frame)
+{
+	struct page *page = frame->page;
+	struct list_elem *e;
+
+	pml4_set_page(page->t->pml4, page->va, frame->kva,
+				  page->writable && frame->ref_cnt == 1);
+	for (e = list_begin(&frame->sharers); e != list_end(&frame->sharers);
+		 e = list_next(e))
+	{
+		page = list_entry(e, struct page, share_elem);
+		pml4_set_page(page->t->pml4, page->va, frame->kva, false);
+	}
+}
+
+/* Removes FRAME from the frame table, keeping the clock hand on a
+ * frame that is still in it.  lru_lock must be held. */
+static void
+frame_table_remove(struct frame *frame)
+{
+	if (clock_hand == &frame->lru_elem)
+		clock_hand = list_next(clock_hand);
+	list_remove(&frame->lru_elem);
 }
 
 /* Evict one page and return the corresponding frame.
  * Return NULL on error.*/
+/* 희생 frame 의 페이지를 페이지 테이블에서 내리고 swap_out 한 뒤 frame 을
+ * 돌려준다. 디스크에 쓰는 동안에는 lru_lock 을 놓아 다른 폴트와 해제가
+ * 기다리지 않게 한다. 그동안 victim 은 frame table 에서 빠져 있고
+ * evicting 이 켜져 있어서, 같은 페이지를 건드리는 쪽은
+ * frame_wait_evicted() 에서 기다린다. fork 로 공유 중인 frame 은 한 번만
+ * 쓰고, 공유하던 페이지들이 같은 swap slot 을 가리키게 한다. */
 static struct frame *
 vm_evict_frame(void)
 {
-	struct frame *victim UNUSED = vm_get_victim();
-	/* TODO: swap out the victim and return the evicted frame. */
+	struct frame *victim;
+	struct page *page;
+	bool success;
 
-	return NULL;
+	lock_acquire(&lru_lock);
+	victim = vm_get_victim();
+	if (victim == NULL)
+	{
+		lock_release(&lru_lock);
+		return NULL;
+	}
+	frame_table_remove(victim);
+	page = victim->page;
+	if (!frame_is_clean(victim))
+		evict_write_cnt++;
+	evict_cnt++;
+
+	/* 먼저 매핑을 지워서 swap_out 도중에 주인이 페이지를 고치지 못하게 한다.
+	 * dirty bit 은 그대로 남으므로 swap_out 에서 확인할 수 있다. */
+	frame_unmap_all(victim);
+	victim->evicting = true;
+	lock_release(&lru_lock);
+
+	success = swap_out(page);
+
+	lock_acquire(&lru_lock);
+	victim->evicting = false;
+	cond_broadcast(&evict_cond, &lru_lock);
+	if (!success)
+	{
+		/* 쫓아내지 못했으면 다시 매핑하고 frame table 에 돌려놓는다. */
+		frame_map_all(victim);
+		frame_table_push(victim);
+		lock_release(&lru_lock);
+		return NULL;
+	}
+	page->frame = NULL;
+	while (!list_empty(&victim->sharers))
+	{
+		struct page *sharer = list_entry(list_pop_front(&victim->sharers),
+										 struct page, share_elem);
+		anon_share_slot(sharer, page);
+		sharer->frame = NULL;
+	}
+	victim->page = NULL;
+	lock_release(&lru_lock);
+
+	return victim;
 }
 
 /* palloc() and get frame. If there is no available page, evict the page
- * and return it. This always return valid address. That is, if the user pool
- * memory is full, this function evicts the frame to get the available memory
- * space.*/
+ * and return it. That is, if the user pool memory is full, this function
+ * evicts the frame to get the available memory space. Returns NULL if
+ * nothing can be evicted, in which case the faulting process is killed. */
 static struct frame *
 vm_get_frame(void)
 {
@@ -178,17 +493,25 @@ vm_get_frame(void)
 
 	if (new_kva = palloc_get_page(PAL_USER))
 	{
-		frame = (struct frame *)malloc(sizeof(struct frame)); 
+		frame = kmem_cache_alloc(&frame_cache);
+		if (frame == NULL)
+		{
+			palloc_free_page(new_kva);
+			return NULL;
+		}
 		frame->kva = new_kva;
 		frame->page = NULL;
+		frame->evicting = false;
 	}
 	else
 	{
-		PANIC("todo");
+		/* user pool 이 가득 찼으면 frame 하나를 쫓아내서 재사용한다. */
+		frame = vm_evict_frame();
+		if (frame == NULL)
+			return NULL;
 	}
 	// frame->thread = thread_current();
 
-	ASSERT(frame != NULL);
 	ASSERT(frame->page == NULL);
 	return frame;
 }
@@ -200,9 +523,52 @@ vm_stack_growth(void *addr UNUSED)
 }
 
 /* Handle the fault on write_protected page */
+/* fork 로 공유된 페이지에 쓰려고 할 때 불린다. 아직 다른 페이지와 공유
+ * 중이면 새 frame 에 내용을 복사해 혼자 쓰고, 마지막 남은 페이지라면 복사
+ * 없이 쓰기 권한만 돌려준다. */
 static bool
-vm_handle_wp(struct page *page UNUSED)
+vm_handle_wp(struct page *page)
 {
+	uint64_t *pml4 = page->t->pml4;
+	struct frame *new_frame, *frame;
+	bool shared;
+
+	lock_acquire(&lru_lock);
+	frame_wait_evicted(page);
+	frame = page->frame;
+	shared = frame != NULL && frame->ref_cnt > 1;
+	if (frame != NULL && !shared)
+		pml4_set_writable(pml4, page->va, true);
+	lock_release(&lru_lock);
+	if (!shared)
+		return true;
+
+	/* 새 frame 을 얻는 동안 다른 페이지가 공유를 풀었을 수 있으므로
+	 * lru_lock 을 다시 잡고 확인한다. 쫓겨났다면 다시 폴트가 나서
+	 * swap 에서 읽어 온다. */
+	new_frame = vm_get_frame();
+	if (new_frame == NULL)
+		return false;
+	lock_acquire(&lru_lock);
+	frame_wait_evicted(page);
+	frame = page->frame;
+	if (frame == NULL || frame->ref_cnt == 1)
+	{
+		if (frame != NULL)
+			pml4_set_writable(pml4, page->va, true);
+		lock_release(&lru_lock);
+		palloc_free_page(new_frame->kva);
+		kmem_cache_free(&frame_cache, new_frame);
+		return true;
+	}
+	memcpy(new_frame->kva, frame->kva, PGSIZE);
+	frame_unshare(frame, page);
+	frame_init(new_frame, page);
+	pml4_set_page(pml4, page->va, new_frame->kva, true);
+	frame_table_push(new_frame);
+	cow_copy_cnt++;
+	lock_release(&lru_lock);
+	return true;
 }
 
 /* Return true on success */
@@ -220,6 +586,7 @@ bool vm_try_handle_fault(struct intr_frame *f UNUSED, void *addr UNUSED,
 
 	if (not_present) /* 페이지가 메모리에 없다면 */
 	{
+		fault_cnt++;
 		if (!vm_claim_page(addr)) /* 페이지를 확보할 수 없다면 */
 		{
 			return false;
@@ -229,6 +596,13 @@ bool vm_try_handle_fault(struct intr_frame *f UNUSED, void *addr UNUSED,
 			return true;
 		}
 	}
+	else if (write) /* 쓰기가 막힌 페이지에 썼다면 */
+	{
+		page = spt_find_page(spt, addr);
+		if (page == NULL || !page->writable)
+			return false;
+		return vm_handle_wp(page);
+	}
 	else
 	{
 		return false;
@@ -239,12 +613,34 @@ bool vm_try_handle_fault(struct intr_frame *f UNUSED, void *addr UNUSED,
 	return vm_do_claim_page(page);
 }
 
-/* Free the page.
- * DO NOT MODIFY THIS FUNCTION. */
+/* Free the page. */
+/* 페이지가 frame 을 가지고 있으면 frame table 에서 빼고 돌려준다.
+ * 매핑도 지워서 pml4_destroy() 가 같은 frame 을 다시 해제하지 않게 한다. */
 void vm_dealloc_page(struct page *page)
 {
+	lock_acquire(&lru_lock);
+	frame_wait_evicted(page);
+	if (page->frame != NULL)
+	{
+		struct frame *frame = page->frame;
+
+		if (page->t->pml4 != NULL)
+			pml4_clear_page(page->t->pml4, page->va);
+		/* 다른 페이지와 공유 중이면 frame 은 남겨 둔다. */
+		if (frame->ref_cnt > 1)
+			frame_unshare(frame, page);
+		else
+		{
+			frame_table_remove(frame);
+			palloc_free_page(frame->kva);
+			kmem_cache_free(&frame_cache, frame);
+			page->frame = NULL;
+		}
+	}
+	lock_release(&lru_lock);
+
 	destroy(page);
-	free(page);
+	kmem_cache_free(&page_cache, page);
 }
 
 /* Claim the page that allocate on VA. */
@@ -267,12 +663,30 @@ bool vm_claim_page(void *va UNUSED)
 static bool
 vm_do_claim_page(struct page *page)
 {
+	struct thread *t = page->t;
+
+	/* read-around 로 미리 읽어 둔 페이지라면 frame 이 이미 있으므로
+	 * 디스크를 읽지 않고 매핑만 한다 (soft fault). 그 사이에 쫓겨나지
+	 * 않도록 lru_lock 을 잡고 처리한다. 쫓겨나는 중이면 끝나기를 기다린 뒤
+	 * swap 에서 다시 읽는다. */
+	lock_acquire(&lru_lock);
+	frame_wait_evicted(page);
+	if (page->frame != NULL)
+	{
+		page->frame->last_use = timer_ticks();
+		bool success = swap_in(page, page->frame->kva) &&
+					   pml4_set_page(t->pml4, page->va, page->frame->kva, page->writable);
+		lock_release(&lru_lock);
+		return success;
+	}
+	lock_release(&lru_lock);
+
+	bool from_swap = anon_is_swapped_out(page);
 	struct frame *frame = vm_get_frame();
 
   if (frame == NULL) return false;
 	/* Set links */
-	frame->page = page;
-	page->frame = frame;
+	frame_init(frame, page);
 
 	/* TODO: Insert page table entry to map page's VA to frame's PA. */
 	// if (!install_page(page->va, frame->kva, page->writable))
@@ -281,19 +695,146 @@ vm_do_claim_page(struct page *page)
 	// }
 	// return swap_in(page, frame->kva);
 
-	struct thread *t = thread_current();
-  list_push_back(&lru, &(frame->lru_elem));
+	/* 내용을 다 읽기 전에 쫓겨나지 않도록, frame table 에는 swap_in 이
+	 * 끝난 뒤에 넣는다. */
+	if (!swap_in(page, frame->kva) ||
+		!pml4_set_page(t->pml4, page->va, frame->kva, page->writable))
+	{
+		page->frame = NULL;
+		palloc_free_page(frame->kva);
+		kmem_cache_free(&frame_cache, frame);
+		return false;
+	}
 
-  if (pml4_set_page(t->pml4, page->va, frame->kva, page->writable) == false) return false;
+	lock_acquire(&lru_lock);
+	frame_table_push(frame);
+	lock_release(&lru_lock);
 
-  return swap_in(page, frame->kva);
+	if (from_swap)
+		vm_read_around(page);
+	return true;
+}
+
+/* PAGE 가 swap 에서 돌아왔을 때, 같은 구간의 이웃 페이지 중 swap 에 나가
+ * 있는 것들도 남는 frame 에 미리 읽어 둔다. 순서대로 다시 접근하는
+ * 작업에서는 이웃도 곧 폴트가 나기 때문이다. 미리 읽은 페이지는 매핑하지
+ * 않고 frame table 에만 넣어 두므로, 쓰이지 않으면 accessed bit 이 꺼진
+ * 채라 clock 이 먼저 내보낸다. 미리 읽기 때문에 다른 frame 을 쫓아내지는
+ * 않는다. */
+static void
+vm_read_around(struct page *page)
+{
+	uint8_t *base = pg_round_down(page->va);
+	size_t i;
+
+	base -= (uint64_t)base % (READ_AROUND_PAGES * PGSIZE);
+	for (i = 0; i < READ_AROUND_PAGES; i++)
+	{
+		struct page *nbr = spt_find_page(&page->t->spt, base + i * PGSIZE);
+		struct frame *frame;
+		void *kva;
+
+		if (nbr == NULL || nbr == page || nbr->frame != NULL ||
+			!anon_is_swapped_out(nbr))
+			continue;
+
+		kva = palloc_get_page(PAL_USER);
+		if (kva == NULL)
+			break;
+		frame = kmem_cache_alloc(&frame_cache);
+		if (frame == NULL)
+		{
+			palloc_free_page(kva);
+			break;
+		}
+		frame->kva = kva;
+		anon_read_ahead(nbr, kva);
+
+		lock_acquire(&lru_lock);
+		frame_init(frame, nbr);
+		frame_table_push(frame);
+		lock_release(&lru_lock);
+	}
 }
 
 /* Initialize new supplemental page table */
 void supplemental_page_table_init(struct supplemental_page_table *spt UNUSED)
 {
-	struct hash cur_hash = spt->hash_table;
-	hash_init(&cur_hash, vm_hash_func, vm_less_func, NULL);
+	hash_init(&spt->hash_table, vm_hash_func, vm_less_func, NULL);
+}
+
+/* PAGE 가 frame 에 올라와 매핑되어 있으면 true. lru_lock 을 잡고 불러야
+ * 한다. */
+static bool
+page_is_mapped(struct page *page)
+{
+	return page->frame != NULL &&
+		   pml4_get_page(page->t->pml4, page->va) != NULL;
+}
+
+/* fork 한 자식의 CHILD 페이지가 부모의 anonymous 페이지 PARENT 와 frame 을
+ * 공유하게 한다. 내용은 복사하지 않고 두 매핑을 모두 읽기 전용으로 만들어
+ * 두며, 먼저 쓰는 쪽이 vm_handle_wp() 에서 복사한다. PARENT 가 swap 에 나가
+ * 있거나 미리 읽기만 된 상태면 먼저 부모 쪽에 매핑한다. */
+static bool
+spt_share_page(struct page *child, struct page *parent)
+{
+	struct frame *frame;
+
+	ASSERT(page_get_type(parent) == VM_ANON);
+
+	for (;;)
+	{
+		lock_acquire(&lru_lock);
+		if (page_is_mapped(parent))
+			break;
+		lock_release(&lru_lock);
+		if (!vm_do_claim_page(parent))
+			return false;
+	}
+
+	/* 내용은 부모의 frame 에 이미 있으므로 CHILD 의 uninit initializer 를
+	 * 부모의 frame 에 돌리지 않고 바로 anonymous 페이지로 만든다. */
+	frame = parent->frame;
+	if (!anon_initializer(child, VM_ANON, NULL) ||
+		!pml4_set_page(child->t->pml4, child->va, frame->kva, false))
+	{
+		lock_release(&lru_lock);
+		return false;
+	}
+	child->frame = frame;
+	list_push_back(&frame->sharers, &child->share_elem);
+	frame->ref_cnt++;
+	pml4_set_writable(parent->t->pml4, parent->va, false);
+	lock_release(&lru_lock);
+	return true;
+}
+
+/* fork 한 자식의 CHILD 페이지에 새 frame 을 주고 부모의 PARENT 페이지
+ * 내용을 복사한다. file-backed 페이지는 frame 을 공유하지 않고 이렇게
+ * 복사한다. */
+static bool
+spt_copy_page(struct page *child, struct page *parent)
+{
+	struct page *missing;
+
+	/* 두 페이지가 모두 올라와 있는 동안 복사한다. 한쪽을 올리는 사이에
+	 * 다른 쪽이 쫓겨났으면 다시 올린다. */
+	for (;;)
+	{
+		lock_acquire(&lru_lock);
+		missing = !page_is_mapped(parent)  ? parent
+				  : !page_is_mapped(child) ? child
+										   : NULL;
+		if (missing == NULL)
+			break;
+		lock_release(&lru_lock);
+		if (!vm_do_claim_page(missing))
+			return false;
+	}
+	memcpy(child->frame->kva, parent->frame->kva, PGSIZE);
+	lock_release(&lru_lock);
+	return true;
 }
 
 /* Copy supplemental page table from src to dst */
@@ -325,9 +866,12 @@ bool supplemental_page_table_copy(struct supplemental_page_table *dst UNUSED,
         }
         else {
             if(!vm_alloc_page(type, upage, writable)) return false;
-            if(!vm_claim_page(upage)) return false;
 						struct page* child_page = spt_find_page(dst, upage);
-            memcpy(child_page->frame->kva, parent_page->frame->kva, PGSIZE);
+						// anonymous 페이지만 copy-on-write 로 공유하고 나머지는 복사
+						if (type == VM_ANON
+								? !spt_share_page(child_page, parent_page)
+								: !spt_copy_page(child_page, parent_page))
+							return false;
         }
     }
     return true;
@@ -357,7 +901,7 @@ static unsigned vm_hash_func(const struct hash_elem *e, void *aux)
 void *hash_va = hash_entry(e, struct page, hash_elem)->va;
 /* hash_int()를 이용해서 vm_entry의 멤버 vaddr에 대한 해시값을
 구하고 반환 */
-return hash_int((uint64_t)&hash_va);
+return hash_bytes(&hash_va, sizeof hash_va);
 }
 
 /*